@@ -97,6 +97,7 @@ struct Data
 
     //Spectrum proposal
     double *p; //!<power spectral density of data
+    double *pcdf; //!<cumulative sum of Data::p used by draw_from_spectrum()
     double pmax; //!<maximum power spectrial density
     double SNR2; //!<estimated \f${\rm SNR}^2\f$ of data
     ///@}
@@ -176,6 +177,13 @@ struct Flags
     int resume;     //!<`[--resume; default=FALSE]`: restart sampler from run state saved during checkpointing. Starts from scratch if no checkpointing files are found.
     int catalog;    //!<`[--catalog=FILENAME; default=FALSE]`: use list of previously detected sources supplied in `FILENAME` to clean bandwidth padding (`gb_mcmc`) or for building family tree (`gb_catalog`).
     int threads;
+    int fullLogL;   //!<`[--full-logL; default=FALSE]`: recompute full likelihood for every fixed-dimension update instead of only over the bandwidth of the updated source
+    int checkLogL;  //!<`[--check-logL=INT; default=0]`: compare incremental likelihood to full recompute every `INT` updates of each chain.  Disabled for `INT=0`.
+    int fstatAdaptive;//!<`[--fstat-adaptive; default=FALSE]`: build F-statistic proposal on a coarse sky grid, refining only around loud cells
+    int tuneProposals;//!<`[--tune-proposals; default=FALSE]`: reweight fixed dimension proposals by accepted moves per second during burn in, see tune_proposal_weights()
+    int delayedAccept;//!<`[--delayed-accept; default=FALSE]`: screen local fixed dimension moves (Proposal::local) with the Fisher approximation to the likelihood before computing waveforms, see galactic_binary_mcmc()
+    int parallelIngest;//!<`[--parallel-ingest; default=FALSE]`: global fit processes read and Fourier transform HDF5 data together, see get_frequency_segment_parallel()
+    int asyncGibbs; //!<`[--async-gibbs=INT; default=0]`: global fit components run without waiting for each other, publishing snapshots of their state every `INT` updates. Lockstep blocked Gibbs sampler for `INT=0`.
     ///@}
 
     
@@ -221,6 +229,9 @@ struct Chain
     /// Array storing \f$\langle \log p(d|\vec\theta)^{1/T} \rangle\f$ for thermodynamic integration.
     double *avgLogL;
     
+    /// Number of incremental likelihood updates made by each chain. Used to schedule checks enabled by Flags::checkLogL.
+    int *nupdate;
+    
     /// Annealing temperature for all chains used during burnin **DEPRICATED**
     double annealing;
     
@@ -279,6 +290,15 @@ struct Chain
      */
     FILE **parameterFile;
     
+    /**
+     \brief Cold chain signal parameters in binary: `chains/parameter_chain.bin`
+     
+     Header is the 8 character tag `GBCHAIN1` followed by two `int`s, the number of columns and zero.
+     Each source sample is then written as `double`s in the same column order as Chain::parameterFile.
+     Read with read_chain_file().
+     */
+    FILE *parameterBinaryFile;
+    
     /**
      \brief Log-likelhood values for each parallel chain.
      
@@ -352,6 +372,9 @@ struct Source
     double **fisher_matrix; //!<Fisher approximation to inverse covariance matrix
     double **fisher_evectr; //!<Eigenvectors of covariance matrix
     double *fisher_evalue;  //!<Eigenvalues of covariance matrix
+    double *fisher_params;  //!<Source::params where the Fisher matrix was last computed
+    int fisher_trial;       //!<draw_from_fisher() trials since the Fisher matrix was last computed
+    int fisher_accept;      //!<draw_from_fisher() acceptances since the Fisher matrix was last computed
     ///@}
 };
 
@@ -380,6 +403,14 @@ struct Noise
     double *SnX;
     ///@}
     
+    ///@name Inverse Noise Model
+    ///Cached \f$1/S_n\f$ for each channel used by the likelihood, see invert_noise()
+    ///@{
+    double *invSnA;
+    double *invSnE;
+    double *invSnX;
+    ///@}
+    
     ///@name UNDER CONSTRUCTION! noise parameters for power-law fit
     ///Parameters are noise levels at reference frequency \f$S_{n,0}\f$ and power law index \f$\alpha\f$.
     ///@{
@@ -230,3 +230,184 @@ int gaussian_mixture_model_wrapper(double **ranges, struct Flags *flags, struct
     
     return 0;
 }
+
+void setup_catalog_gmm(struct Catalog *catalog, int NP)
+{
+    struct CatalogGMM *gmm = malloc(sizeof(struct CatalogGMM));
+    
+    gmm->NP     = NP;
+    gmm->Nentry = catalog->N;
+    gmm->first  = malloc((catalog->N+1)*sizeof(int));
+    
+    gmm->first[0] = 0;
+    for(int n=0; n<catalog->N; n++) gmm->first[n+1] = gmm->first[n] + (int)catalog->entry[n]->gmm->NMODE;
+    gmm->Nmode = gmm->first[catalog->N];
+    
+    gmm->minmax = malloc(catalog->N*NP*2*sizeof(double));
+    gmm->mu     = malloc(gmm->Nmode*NP*sizeof(double));
+    gmm->L      = calloc(gmm->Nmode*NP*NP,sizeof(double));
+    gmm->Linv   = calloc(gmm->Nmode*NP*NP,sizeof(double));
+    gmm->logw   = malloc(gmm->Nmode*sizeof(double));
+    gmm->cdf    = malloc(gmm->Nmode*sizeof(double));
+    
+    for(int n=0; n<catalog->N; n++)
+    {
+        struct MVG **modes = catalog->entry[n]->gmm->modes;
+        int NMODE = (int)catalog->entry[n]->gmm->NMODE;
+        
+        //all modes of an entry share the logit range
+        for(int i=0; i<NP; i++)
+        {
+            gmm->minmax[(n*NP+i)*2]   = gsl_matrix_get(modes[0]->minmax,i,0);
+            gmm->minmax[(n*NP+i)*2+1] = gsl_matrix_get(modes[0]->minmax,i,1);
+        }
+        
+        double norm = 0.0;
+        for(int k=0; k<NMODE; k++) norm += modes[k]->p;
+        
+        double cdf = 0.0;
+        for(int k=0; k<NMODE; k++)
+        {
+            int m = gmm->first[n]+k;
+            double *mu   = gmm->mu + m*NP;
+            double *L    = gmm->L + m*NP*NP;
+            double *Linv = gmm->Linv + m*NP*NP;
+            
+            for(int i=0; i<NP; i++) mu[i] = gsl_vector_get(modes[k]->mu,i);
+            for(int i=0; i<NP; i++) for(int j=0; j<=i; j++) L[i*NP+j] = gsl_matrix_get(modes[k]->L,i,j);
+            
+            //invert lower triangular L by forward substitution
+            double logdetL = 0.0;
+            for(int j=0; j<NP; j++)
+            {
+                Linv[j*NP+j] = 1.0/L[j*NP+j];
+                for(int i=j+1; i<NP; i++)
+                {
+                    double sum = 0.0;
+                    for(int l=j; l<i; l++) sum += L[i*NP+l]*Linv[l*NP+j];
+                    Linv[i*NP+j] = -sum/L[i*NP+i];
+                }
+                logdetL += log(fabs(L[j*NP+j]));
+            }
+            
+            gmm->logw[m] = log(modes[k]->p/norm) - 0.5*NP*log(PI2) - logdetL;
+            
+            cdf += modes[k]->p/norm;
+            gmm->cdf[m] = cdf;
+        }
+        gmm->cdf[gmm->first[n+1]-1] = 1.0;
+    }
+    
+    //index entries by lowest frequency
+    gmm->order = malloc(catalog->N*sizeof(int));
+    gmm->fmin  = malloc(catalog->N*sizeof(double));
+    gmm->fmax  = malloc(catalog->N*sizeof(double));
+    
+    double *f = malloc(catalog->N*sizeof(double));
+    size_t *index = malloc(catalog->N*sizeof(size_t));
+    for(int n=0; n<catalog->N; n++) f[n] = gmm->minmax[n*NP*2];
+    gsl_sort_index(index, f, 1, catalog->N);
+    
+    for(int n=0; n<catalog->N; n++)
+    {
+        int e = (int)index[n];
+        gmm->order[n] = e;
+        gmm->fmin[n]  = gmm->minmax[e*NP*2];
+        gmm->fmax[n]  = gmm->minmax[e*NP*2+1];
+        if(n>0 && gmm->fmax[n-1] > gmm->fmax[n]) gmm->fmax[n] = gmm->fmax[n-1];
+    }
+    free(f);
+    free(index);
+    
+    catalog->gmm = gmm;
+}
+
+double catalog_gmm_entry_density(struct CatalogGMM *gmm, int entry, double *params, double T)
+{
+    int NP = gmm->NP;
+    double x[NP];
+    double y[NP];
+    
+    if(gmm->first[entry+1] == gmm->first[entry]) return -INFINITY;
+    
+    //physical parameters, same convention as Source
+    x[0] = params[0]/T;
+    x[1] = params[1];
+    x[2] = params[2];
+    x[3] = params[3];
+    x[4] = params[4];
+    x[5] = params[5];
+    x[6] = params[6];
+    if(NP>7) x[7] = params[7]/(T*T);
+    if(NP>8) x[8] = params[8]/(T*T*T);
+    
+    //map parameters to R
+    double logJ = 0.0;
+    double *minmax = gmm->minmax + entry*NP*2;
+    for(int i=0; i<NP; i++)
+    {
+        double xmin = minmax[2*i];
+        double xmax = minmax[2*i+1];
+        if(x[i] < xmin || x[i] >= xmax) return -INFINITY;
+        
+        y[i] = log((x[i]-xmin)/(xmax-x[i]));
+        logJ += log(xmax-xmin) - log(x[i]-xmin) - log(xmax-x[i]);
+    }
+    
+    //log-sum-exp over modes
+    double logPmax = -INFINITY;
+    double logP[gmm->first[entry+1]-gmm->first[entry]];
+    for(int m=gmm->first[entry]; m<gmm->first[entry+1]; m++)
+    {
+        double *mu   = gmm->mu + m*NP;
+        double *Linv = gmm->Linv + m*NP*NP;
+        double dx[NP];
+        for(int i=0; i<NP; i++) dx[i] = y[i] - mu[i];
+        
+        double chi2 = 0.0;
+        for(int i=0; i<NP; i++)
+        {
+            double z = 0.0;
+            #pragma omp simd reduction(+:z)
+            for(int j=0; j<NP; j++) z += Linv[i*NP+j]*dx[j];
+            chi2 += z*z;
+        }
+        
+        double lp = gmm->logw[m] - 0.5*chi2;
+        logP[m-gmm->first[entry]] = lp;
+        if(lp > logPmax) logPmax = lp;
+    }
+    if(logPmax == -INFINITY) return -INFINITY;
+    
+    double P = 0.0;
+    for(int m=0; m<gmm->first[entry+1]-gmm->first[entry]; m++) P += exp(logP[m]-logPmax);
+    
+    return logPmax + log(P) + logJ;
+}
+
+double catalog_gmm_density(struct CatalogGMM *gmm, double *params, double T)
+{
+    double f0 = params[0]/T;
+    
+    //last sorted entry starting below f0
+    int lo = -1;
+    int hi = gmm->Nentry;
+    while(hi-lo>1)
+    {
+        int mid = (lo+hi)/2;
+        if(gmm->fmin[mid] <= f0) lo = mid;
+        else hi = mid;
+    }
+    
+    //walk down until no earlier entry can reach f0, accumulating with log-sum-exp
+    double logP = -INFINITY;
+    for(int n=lo; n>=0 && gmm->fmax[n] > f0; n--)
+    {
+        double logPn = catalog_gmm_entry_density(gmm, gmm->order[n], params, T);
+        if(logPn == -INFINITY) continue;
+        if(logPn > logP) logP = logPn + log(1.0 + exp(logP-logPn));
+        else logP = logP + log(1.0 + exp(logPn-logP));
+    }
+    
+    return logP - log((double)gmm->Nentry);
+}
@@ -38,6 +38,33 @@ struct Catalog
 {
     int N; //!<number of discrete sources in catalog
     struct Entry **entry; //!<discrete catalog entries
+    struct CatalogGMM *gmm; //!<flattened Gaussian Mixture Models of all entries, see setup_catalog_gmm()
+};
+
+/*!
+ \brief Gaussian Mixture Models of every catalog entry packed into flat arrays.
+ 
+ Modes of entry `n` are `first[n]` through `first[n+1]-1`.
+ Means are stored as `Nmode x NP` and Cholesky factors as `Nmode x NP x NP`, row major.
+ Parameters are \f$[f_0,\cos\theta,\phi,\log\mathcal{A},\cos\iota,\psi,\varphi_0,\dot f,\ddot f]\f$,
+ logit-mapped onto the range of each entry before the Gaussians are evaluated.
+ Entries are sorted by their lowest frequency so a density only visits entries that overlap \f$f_0\f$.
+ */
+struct CatalogGMM
+{
+    int NP;         //!<number of parameters
+    int Nentry;     //!<number of catalog entries
+    int Nmode;      //!<total number of modes over all entries
+    int *first;     //!<index of first mode of each entry, `Nentry+1` elements
+    double *minmax; //!<logit range of each entry, `Nentry x NP x 2`
+    double *mu;     //!<mode means
+    double *L;      //!<Cholesky factor of mode covariance \f$C=LL^T\f$
+    double *Linv;   //!<inverse Cholesky factor, \f$(x-\mu)^TC^{-1}(x-\mu) = |L^{-1}(x-\mu)|^2\f$
+    double *logw;   //!<mode weight and normalization \f$\log p_k - \frac{1}{2}\log|2\pi C_k|\f$
+    double *cdf;    //!<cumulative mode weights within each entry
+    int *order;     //!<entries sorted by lowest frequency
+    double *fmin;   //!<lowest frequency of sorted entries [Hz]
+    double *fmax;   //!<running maximum of highest frequency of sorted entries [Hz]
 };
 
 /*!
@@ -86,5 +113,28 @@ void append_sample_to_entry(struct Entry *entry, struct Source *sample, int IMAX
  */
 int gaussian_mixture_model_wrapper(double **ranges, struct Flags *flags, struct Entry *entry, char *outdir, size_t NP, size_t NMODE, size_t NTHIN, gsl_rng *seed, double *BIC);
 
+/**
+ \brief Packs the Gaussian Mixture Models of every catalog entry into Catalog::gmm.
+ 
+ Mode weights are normalized within each entry, and the Cholesky factors stored with
+ each mode are inverted once so densities can be evaluated without allocating.
+ */
+void setup_catalog_gmm(struct Catalog *catalog, int NP);
+
+/**
+ \brief Log density of catalog entry `entry` at sampler parameters `params`.
+ 
+ Sums modes with log-sum-exp, including the Jacobian of the logit map.
+ @returns \f$-\infty\f$ outside of the entry's parameter range
+ */
+double catalog_gmm_entry_density(struct CatalogGMM *gmm, int entry, double *params, double T);
+
+/**
+ \brief Log of the density averaged over all catalog entries at sampler parameters `params`.
+ 
+ Only entries whose frequency range contains \f$f_0\f$ are evaluated.
+ */
+double catalog_gmm_density(struct CatalogGMM *gmm, double *params, double T);
+
 
 #endif /* GalacticBinaryCatalog_h */
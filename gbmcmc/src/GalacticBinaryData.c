@@ -26,7 +26,6 @@
 
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
-#include <gsl/gsl_fft_real.h>
 
 #include <LISA.h>
 #include <GMM_with_EM.h>
@@ -42,22 +41,21 @@
 #define TUKEY_FILTER_LENGTH 1e5 //seconds
 #define N_TDI_CHANNELS 3
 
-static void tukey(double *data, double alpha, int N)
+static double tukey_filter(int i, double alpha, int N)
 {
-    int i, imin, imax;
-    double filter;
+    int imin = (int)(alpha*(double)(N-1)/2.0);
+    int imax = (int)((double)(N-1)*(1.0-alpha/2.0));
     
-    imin = (int)(alpha*(double)(N-1)/2.0);
-    imax = (int)((double)(N-1)*(1.0-alpha/2.0));
-    
-    for(i=0; i< N; i++)
-    {
-        filter = 1.0;
-        if(i < imin) filter = 0.5*(1.0+cos(M_PI*( (double)(i)/(double)(imin)-1.0 )));
-        if(i>imax) filter = 0.5*(1.0+cos(M_PI*( (double)(i)/(double)(imin)-2.0/alpha+1.0 )));
-        data[i] *= filter;
-    }
+    double filter = 1.0;
+    if(i < imin) filter = 0.5*(1.0+cos(M_PI*( (double)(i)/(double)(imin)-1.0 )));
+    if(i>imax) filter = 0.5*(1.0+cos(M_PI*( (double)(i)/(double)(imin)-2.0/alpha+1.0 )));
     
+    return filter;
+}
+
+static void tukey(double *data, double alpha, int N)
+{
+    for(int i=0; i< N; i++) data[i] *= tukey_filter(i, alpha, N);
 }
 
 static double tukey_scale(double alpha, int N)
@@ -151,18 +149,8 @@ void GalacticBinaryReadHDF5(struct Data *data, struct TDI *tdi)
     gsl_fft_real_radix2_transform(T, 1, NFFT);*/
     
     /* Fourier transform time-domain TDI channels */
-    gsl_fft_real_wavetable * real = gsl_fft_real_wavetable_alloc (NFFT);;
-    gsl_fft_real_workspace * work = gsl_fft_real_workspace_alloc (NFFT);;
-
-    gsl_fft_real_transform (X, 1, NFFT, real, work);
-    gsl_fft_real_transform (Y, 1, NFFT, real, work);
-    gsl_fft_real_transform (Z, 1, NFFT, real, work);
-    gsl_fft_real_transform (A, 1, NFFT, real, work);
-    gsl_fft_real_transform (E, 1, NFFT, real, work);
-    gsl_fft_real_transform (T, 1, NFFT, real, work);
-
-    gsl_fft_real_wavetable_free (real);
-    gsl_fft_real_workspace_free (work);
+    double *channels[6] = {X, Y, Z, A, E, T};
+    real_fft_forward(channels, NFFT, 6);
 
     
     /* Normalize FD data */
@@ -253,6 +241,36 @@ void GalacticBinaryReadHDF5(struct Data *data, struct TDI *tdi)
     
 }
 
+int GalacticBinaryReadHDF5Slice(struct Data *data, struct TDI *tdi, double dt, int slice, int Nslice)
+{
+    /* Select time segment of full data set, same as GalacticBinaryReadHDF5() */
+    double start_time = data->t0[0];
+    double stop_time = start_time + data->T;
+    double Tobs = stop_time - start_time;
+    
+    int NFFT = (int)floor(Tobs/dt);
+    int n_start = (int)floor(start_time/dt); // first sample of time segment
+    
+    /* this process's slice of the segment */
+    int Nsamples = NFFT/Nslice;
+    int n_slice = slice*Nsamples;
+    
+    LISA_Read_HDF5_LDC_TDI_Hyperslab(tdi, data->fileName, n_start + n_slice, Nsamples);
+    
+    /* Tukey window and normalize so the slices' Fourier transforms add up to the full segment's */
+    double alpha = (2.0*TUKEY_FILTER_LENGTH/Tobs);
+    double norm = 2./sqrt((double)(NFFT)) / tukey_scale(alpha, NFFT);
+    
+    double *channels[6] = {tdi->X, tdi->Y, tdi->Z, tdi->A, tdi->E, tdi->T};
+    for(int n=0; n<Nsamples; n++)
+    {
+        double filter = norm*tukey_filter(n_slice+n, alpha, NFFT);
+        for(int k=0; k<6; k++) channels[k][n] *= filter;
+    }
+    
+    return NFFT;
+}
+
 void GalacticBinaryReadASCII(struct Data *data, struct TDI *tdi)
 {
     double f;
@@ -369,6 +387,7 @@ void GalacticBinaryGetNoiseModel(struct Data *data, struct Orbit *orbit, struct
             exit(1);
         }
     }
+    invert_noise(data->noise[0]);
 }
 
 void GalacticBinaryAddNoise(struct Data *data, struct TDI *tdi)
@@ -1064,6 +1083,9 @@ void GalacticBinaryLoadCatalog(struct Data *data)
         fclose(fptr);
 
     }
+    
+    /* pack GMMs for fast density evaluation */
+    setup_catalog_gmm(data->catalog, data->NP);
 }
 
 void GalacticBinaryCleanEdges(struct Data *data, struct Orbit *orbit, struct Flags *flags)
@@ -39,6 +39,20 @@ void GalacticBinaryReadData(struct Data *data, struct Orbit *orbit, struct Flags
  */
 void GalacticBinaryReadHDF5(struct Data *data, struct TDI *tdi);
 
+/**
+ \brief Reads time slice `slice` of `Nslice` from LDC-formatted HDF5 data
+ 
+ The data segment selected by GalacticBinaryReadHDF5() is divided into `Nslice` equal
+ slices. Slice samples are Tukey windowed and scaled with the full segment's
+ normalization, so only a Fourier transform is needed to get the segment's
+ frequency series.
+ 
+ @param[out] tdi time domain samples of the slice
+ @param[in] dt sample cadence of the HDF5 data
+ @returns number of samples in the full segment
+ */
+int GalacticBinaryReadHDF5Slice(struct Data *data, struct TDI *tdi, double dt, int slice, int Nslice);
+
 /**
  \brief Reads ASCII data using `--data` flag
  */
@@ -29,6 +29,7 @@
 //
 //
 #include <math.h>
+#include <string.h>
 
 #include <LISA.h>
 
@@ -48,9 +49,10 @@ void initialize_XLS(long M, double *XLS, double *AA, double *EE)
     }
 }
 
-void init_A_filters(struct Orbit *orbit, struct Data *data, struct Filter *F_filter)
+void alloc_Filter(struct Filter *F_filter, long M)
 {
-    long M = F_filter->M_filter;
+    F_filter->M_filter = M;
+    F_filter->N_filter = M;
     
     F_filter->A1_fX = calloc((2*M),sizeof(double));
     F_filter->A2_fX = calloc((2*M),sizeof(double));
@@ -67,18 +69,56 @@ void init_A_filters(struct Orbit *orbit, struct Data *data, struct Filter *F_fil
     F_filter->A3_fE = calloc((2*M),sizeof(double));
     F_filter->A4_fE = calloc((2*M),sizeof(double));
     
+    F_filter->M_inv_X  = malloc(4*sizeof(double *));
+    F_filter->M_inv_AE = malloc(4*sizeof(double *));
+    for(int i=0; i<4; i++)
+    {
+        F_filter->M_inv_X[i]  = calloc(4,sizeof(double));
+        F_filter->M_inv_AE[i] = calloc(4,sizeof(double));
+    }
+}
+
+/*
+ Per-thread Filter reused across get_Fstat_logL() calls so that grid
+ scans do not allocate and free 14 arrays per cell.
+ */
+static struct Filter *fstat_workspace = NULL;
+#pragma omp threadprivate(fstat_workspace)
+
+static struct Filter *get_Fstat_workspace(long M)
+{
+    if(fstat_workspace != NULL && fstat_workspace->M_filter != M)
+    {
+        free_Filter(fstat_workspace);
+        fstat_workspace = NULL;
+    }
+    if(fstat_workspace == NULL)
+    {
+        fstat_workspace = malloc(sizeof(struct Filter));
+        alloc_Filter(fstat_workspace, M);
+    }
+    return fstat_workspace;
+}
+
+void init_A_filters(struct Orbit *orbit, struct Data *data, struct Filter *F_filter)
+{
+    long M = F_filter->M_filter;
+    
     initialize_XLS(M, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE);
     initialize_XLS(M, F_filter->A2_fX, F_filter->A2_fA, F_filter->A2_fE);
     initialize_XLS(M, F_filter->A3_fX, F_filter->A3_fA, F_filter->A3_fE);
     initialize_XLS(M, F_filter->A4_fX, F_filter->A4_fA, F_filter->A4_fE);
     
-    //   get_filters(orbit, data, 1, F_filter);
-    //   get_filters(orbit, data, 2, F_filter);
-    //   get_filters(orbit, data, 2, F_filter);
-    //   get_filters(orbit, data, 2, F_filter);
+    /*
+     All four filters are evaluated at iota = pi/2, where the source is purely
+     plus-polarized in its own frame, and differ only in (psi, phase).
+     A^{3} (psi=0) is the plus response and A^{4} (psi=pi/4) is the cross response,
+     each times 2*exp(-i phase), so both follow from one pass over the
+     polarization basis. A^{1} and A^{2} are then phase shifts of A^{3} and A^{4}.
+     */
+    get_filter_basis(orbit, data, F_filter);
     
     // Make use of a phase shift to quickly generate other filters
-    get_filters(orbit, data, 3, F_filter);    
     // copy  F_filter->A3_fX into F_filter->A1_fX
     for (int i=0; i<M; i++)
     {
@@ -92,7 +132,6 @@ void init_A_filters(struct Orbit *orbit, struct Data *data, struct Filter *F_fil
         F_filter->A1_fE[2*i] =  F_filter->A3_fE[2*i+1];
     }
     
-    get_filters(orbit, data, 4, F_filter);
     for (int i=0; i<M; i++)
     {
         F_filter->A2_fX[2*i+1]    = -F_filter->A4_fX[2*i];
@@ -112,13 +151,8 @@ void init_M_matrix(struct Filter *F_filter, struct Data *data)
 {
     long i,j;
     
-    F_filter->M_inv_X  = malloc(4*sizeof(double *));//dmatrix(0,3,0,3);
-    F_filter->M_inv_AE = malloc(4*sizeof(double *));//dmatrix(0,3,0,3);
     for(i=0; i<4; i++)
     {
-        F_filter->M_inv_X[i]  = calloc(4,sizeof(double));//dmatrix(0,3,0,3);
-        F_filter->M_inv_AE[i] = calloc(4,sizeof(double));//dmatrix(0,3,0,3);
-        
         for (j=0;j<4;j++)
         {
             F_filter->M_inv_X[i][j]  = 0.0;
@@ -157,123 +191,41 @@ void free_Filter(struct Filter *F_filter)
     free(F_filter);
 }
 
-void get_filters(struct Orbit *orbit, struct Data *data, int filter_id, struct Filter *F_filter)
+void get_filter_basis(struct Orbit *orbit, struct Data *data, struct Filter *F_filter)
 {
-    int i;
-    int d=9;
-    double A_f,iota_f,psi_f,phase_f;
-    double *params;
-    long M_filter;
-    
-    M_filter = F_filter->M_filter;
-    
-    params = calloc(d,sizeof(double));  // allocate memory for filter parameters
-    for (i=0;i<d;i++)  		 // initialize the array to zeros
+    long M_filter = F_filter->M_filter;
+    double params[9] = {0};
+    
+    // set the parameters, mapped to conventions for waveform generator
+    params[0] = F_filter->f0*data->T;
+    params[1] = cos(F_filter->theta);
+    params[2] = F_filter->phi;
+    params[7] = F_filter->fdot*data->T*data->T;
+    params[8] = F_filter->fddot*data->T*data->T*data->T;
+    
+    // unit plus response into A^{3}, unit cross response into A^{4}
+    galactic_binary_polarizations(orbit, data->format, data->T, data->t0[0], params, 9,
+                                  F_filter->A3_fX, F_filter->A3_fA, F_filter->A3_fE,
+                                  F_filter->A4_fX, F_filter->A4_fA, F_filter->A4_fE,
+                                  M_filter, 2);
+    
+    /*
+     A^{3} = 2 exp(-i 3pi/2) h+ and A^{4} = -2 exp(-i pi/2) hx are both 2i times the basis.
+     The "phase" TDI channels are returned complex conjugated, so the factor is -2i there.
+     */
+    double s = (strcmp("phase",data->format) == 0) ? -2.0 : 2.0;
+    
+    double *filter[6] = {F_filter->A3_fX, F_filter->A3_fA, F_filter->A3_fE, F_filter->A4_fX, F_filter->A4_fA, F_filter->A4_fE};
+    for(int n=0; n<6; n++)
     {
-        params[i] = 0.0;
-    }
-    
-    // set the parameters
-    params[0] = F_filter->f0;				 // f0
-    params[1] = F_filter->theta;    	     // theta
-    params[2] = F_filter->phi; 			     // phi
-    
-    params[7] = F_filter->fdot;				 // fdot
-    params[8] = F_filter->fddot;			 // fddot
-    
-    // map to conventions for waveform generator
-    params[0]*=data->T;
-    params[1]=cos(params[1]);
-    params[7]*=(data->T*data->T);
-    params[8]*=(data->T*data->T*data->T);
-    
-    // Now need to calculate the Filters A^{i} (Cornish & Crowder '05)
-    // A^{1} -> iota = pi/2, psi = 0,    A = 2, phase = 0
-    // A^{2} -> iota = pi/2, psi = pi/4, A = 2, phase = pi
-    // A^{3} -> iota = pi/2, psi = 0,    A = 2, phase = 3*pi/2
-    // A^{4} -> iota = pi/2, psi = pi/4, A = 2, phase = pi/2
-    
-    
-    // determine which parameters to pass into FAST_LISA
-    if (filter_id == 1)
-    {
-        A_f      = 2.0;
-        iota_f   = PIon2;
-        psi_f    = 0.0;
-        phase_f  = 0.0;
-        
-        params[3] = A_f;
-        params[4] = iota_f;
-        params[5] = psi_f;
-        params[6] = phase_f;
-        
-        
-        
-        //FAST_LISA(params, N_filter, M_filter, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE);
-        // map to conventions for waveform generator
-        params[3]=log(params[3]);
-        params[4]=cos(params[4]);
-        galactic_binary(orbit, data->format, data->T, data->t0[0], params, data->NP, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE, M_filter, 2);
-        
-    } else if (filter_id == 2){
-        
-        A_f      = 2.0;
-        iota_f   = PIon2;
-        psi_f    = PIon4;
-        phase_f  = M_PI;
-        
-        params[3] = A_f;
-        params[4] = iota_f;
-        params[5] = psi_f;
-        params[6] = phase_f;
-        
-        
-        //FAST_LISA(params, N_filter, M_filter, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE);
-        // map to conventions for waveform generator
-        params[3]=log(params[3]);
-        params[4]=cos(params[4]);
-        galactic_binary(orbit, data->format, data->T, data->t0[0], params, data->NP, F_filter->A2_fX, F_filter->A2_fA, F_filter->A2_fE, M_filter, 2);
-        
-    } else if (filter_id == 3){
-        
-        A_f      = 2.0;
-        iota_f   = PIon2;
-        psi_f    = 0.0;
-        phase_f  = 3.0*PIon2;
-        
-        params[3] = A_f;
-        params[4] = iota_f;
-        params[5] = psi_f;
-        params[6] = phase_f;
-        
-        
-        //FAST_LISA(params, N_filter, M_filter, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE);
-        // map to conventions for waveform generator
-        params[3]=log(params[3]);
-        params[4]=cos(params[4]);
-        galactic_binary(orbit, data->format, data->T, data->t0[0], params, data->NP, F_filter->A3_fX, F_filter->A3_fA, F_filter->A3_fE, M_filter, 2);
-        
-    } else {
-        
-        A_f      = 2.0;
-        iota_f   = PIon2;
-        psi_f    = PIon4;
-        phase_f  = PIon2;
-        
-        params[3] = A_f;
-        params[4] = iota_f;
-        params[5] = psi_f;
-        params[6] = phase_f;
-        
-        
-        //FAST_LISA(params, N_filter, M_filter, F_filter->A1_fX, F_filter->A1_fA, F_filter->A1_fE);
-        // map to conventions for waveform generator
-        params[3]=log(params[3]);
-        params[4]=cos(params[4]);
-        galactic_binary(orbit, data->format, data->T, data->t0[0], params, 9, F_filter->A4_fX, F_filter->A4_fA, F_filter->A4_fE, M_filter, 2);
+        double *h = filter[n];
+        for(long i=0; i<M_filter; i++)
+        {
+            double re = h[2*i];
+            h[2*i]   = -s*h[2*i+1];
+            h[2*i+1] =  s*re;
+        }
     }
-    
-    free(params);
 }
 
 void get_N(struct Data *data, struct Filter *F_filter)
@@ -574,17 +526,13 @@ void calc_a_i(struct Filter *F_filter)
 
 void get_Fstat_logL(struct Orbit *orbit, struct Data *data, double f0, double fdot, double theta, double phi, double *logL_X, double *logL_AE, double *Fparams)
 {
-    long M_filter, N_filter;
+    long M_filter;
     M_filter = (data->N-2*data->qpad)/4;
-    N_filter = (data->N-2*data->qpad)/4;
     long q;
     
     q = (long)(f0*data->T); 	// carrier frequency bin
     
-    struct Filter *F_filter = malloc(sizeof(struct Filter));
-    
-    F_filter->M_filter = M_filter;
-    F_filter->N_filter = N_filter;
+    struct Filter *F_filter = get_Fstat_workspace(M_filter);
     
     F_filter->f0     = f0;
     F_filter->fdot   = fdot;
@@ -624,21 +572,15 @@ void get_Fstat_logL(struct Orbit *orbit, struct Data *data, double f0, double fd
     Fparams[1] = F_filter->iota_AE_Fstat;
     Fparams[2] = F_filter->psi_AE_Fstat;
     Fparams[3] = F_filter->phase_AE_Fstat;
-    
-    free_Filter(F_filter);
 }
 
 void get_Fstat_xmax(struct Orbit *orbit, struct Data *data, double *x, double *xmax)
 {
-    long M_filter, N_filter;
+    long M_filter;
     
     M_filter = (data->N-2*data->qpad)/4;
-    N_filter = (data->N-2*data->qpad)/4;
         
-    struct Filter *F_filter = malloc(sizeof(struct Filter));
-    
-    F_filter->M_filter = M_filter;
-    F_filter->N_filter = N_filter;
+    struct Filter *F_filter = get_Fstat_workspace(M_filter);
     
     double f0 = x[0]/data->T;
     double theta = acos(x[1]);
@@ -679,7 +621,6 @@ void get_Fstat_xmax(struct Orbit *orbit, struct Data *data, double *x, double *x
     xmax[5] = F_filter->psi_AE_Fstat;
     xmax[6] = F_filter->phase_AE_Fstat;
     
-    free_Filter(F_filter);
 }
 
 
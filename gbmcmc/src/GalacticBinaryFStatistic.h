@@ -48,7 +48,7 @@ struct Filter
 
 void initialize_XLS(long M, double *XLS, double *AA, double *EE);
 
-void get_filters(struct Orbit *orbit, struct Data *data, int filter_id, struct Filter *F_filter);
+void get_filter_basis(struct Orbit *orbit, struct Data *data, struct Filter *F_filter);
 
 void get_N(struct Data *data, struct Filter *F_filter);
 
@@ -59,6 +59,8 @@ void calc_Fstat_logL(struct Filter *F_filter);
 
 void calc_a_i(struct Filter *F_filter);
 
+void alloc_Filter(struct Filter *F_filter, long M);
+
 void init_A_filters(struct Orbit *orbit, struct Data *data, struct Filter *F_filter);
 
 void init_M_matrix(struct Filter *F_filter, struct Data *data);
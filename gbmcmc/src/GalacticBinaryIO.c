@@ -24,7 +24,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <omp.h>
 
 #include <gsl/gsl_sort.h>
@@ -260,6 +263,13 @@ void print_usage()
     fprintf(stdout,"       --no-burnin   : skip burn in steps                  \n");
     fprintf(stdout,"       --resume      : restart from checkpoint             \n");
     fprintf(stdout,"       --threads     : number of parallel threads (max)    \n");
+    fprintf(stdout,"       --full-logL   : full likelihood for every update    \n");
+    fprintf(stdout,"       --check-logL  : check incremental logL every N steps\n");
+    fprintf(stdout,"       --fstat-adaptive: coarse-to-fine F-stat sky grid    \n");
+    fprintf(stdout,"       --tune-proposals: tune proposal weights in burn in  \n");
+    fprintf(stdout,"       --delayed-accept: Fisher likelihood screen for moves\n");
+    fprintf(stdout,"       --parallel-ingest: all processes read & FFT h5 data \n");
+    fprintf(stdout,"       --async-gibbs : asynchronous global fit, share every N\n");
     fprintf(stdout,"\n");
     
     //Model
@@ -349,6 +359,13 @@ void parse(int argc, char **argv, struct Data *data, struct Orbit *orbit, struct
     flags->NMCMC       = 100000;
     flags->NBURN       = 100000;
     flags->threads     = omp_get_max_threads();
+    flags->fullLogL    = 0;
+    flags->checkLogL   = 0;
+    flags->fstatAdaptive = 0;
+    flags->tuneProposals = 0;
+    flags->delayedAccept = 0;
+    flags->parallelIngest = 0;
+    flags->asyncGibbs  = 0;
     sprintf(flags->runDir,"./");
     chain->NP          = 9; //number of proposals
     chain->NC          = 12;//number of chains
@@ -413,6 +430,8 @@ void parse(int argc, char **argv, struct Data *data, struct Orbit *orbit, struct
         {"catalog",   required_argument, 0, 0},
         {"threads",   required_argument, 0, 0},
         {"rundir",    required_argument, 0, 0},
+        {"check-logL",required_argument, 0, 0},
+        {"async-gibbs",required_argument, 0, 0},
         
         /* These options don’t set a flag.
          We distinguish them by their indices. */
@@ -439,6 +458,11 @@ void parse(int argc, char **argv, struct Data *data, struct Orbit *orbit, struct
         {"no-rj",       no_argument, 0, 0 },
         {"fit-gap",     no_argument, 0, 0 },
         {"calibration", no_argument, 0, 0 },
+        {"full-logL",   no_argument, 0, 0 },
+        {"fstat-adaptive",no_argument, 0, 0 },
+        {"tune-proposals",no_argument, 0, 0 },
+        {"delayed-accept",no_argument, 0, 0 },
+        {"parallel-ingest",no_argument, 0, 0 },
         {0, 0, 0, 0}
     };
     
@@ -479,6 +503,13 @@ void parse(int argc, char **argv, struct Data *data, struct Orbit *orbit, struct
                 if(strcmp("calibration", long_options[long_index].name) == 0) flags->calibration= 1;
                 if(strcmp("resume",      long_options[long_index].name) == 0) flags->resume     = 1;
                 if(strcmp("threads",     long_options[long_index].name) == 0) flags->threads    = atoi(optarg);
+                if(strcmp("full-logL",   long_options[long_index].name) == 0) flags->fullLogL   = 1;
+                if(strcmp("fstat-adaptive",long_options[long_index].name) == 0) flags->fstatAdaptive = 1;
+                if(strcmp("tune-proposals",long_options[long_index].name) == 0) flags->tuneProposals = 1;
+                if(strcmp("delayed-accept",long_options[long_index].name) == 0) flags->delayedAccept = 1;
+                if(strcmp("parallel-ingest",long_options[long_index].name) == 0) flags->parallelIngest = 1;
+                if(strcmp("check-logL",  long_options[long_index].name) == 0) flags->checkLogL  = atoi(optarg);
+                if(strcmp("async-gibbs", long_options[long_index].name) == 0) flags->asyncGibbs = atoi(optarg);
                 if(strcmp("rundir",      long_options[long_index].name) == 0)
                 {
                     strcpy(flags->runDir,optarg);
@@ -795,6 +826,7 @@ void print_chain_files(struct Data *data, struct Model **model, struct Chain *ch
     for(i=0; i<D; i++)
     {
         print_source_params(data,model[n]->source[i],chain->parameterFile[0]);
+        print_source_params_binary(data,model[n]->source[i],chain->parameterBinaryFile);
         if(flags->verbose)
         {
             //numerical SNR
@@ -1015,6 +1047,138 @@ void scan_source_params(struct Data *data, struct Source *source, FILE *fptr)
     
 }
 
+#define CHAIN_BINARY_TAG "GBCHAIN1"
+#define CHAIN_BINARY_HEADER 16
+
+/* columns of print_source_params(), d2fdt2 is only written for NP>8 */
+static int source_params_columns(int NP)
+{
+    return (NP>8) ? 9 : 8;
+}
+
+static void unpack_source_params(struct Data *data, const double *x, int Ncol, double *params)
+{
+    //only the scalar fields of source are used by map_params_to_array()
+    struct Source source;
+    source.NP       = data->NP;
+    source.f0       = x[0];
+    source.dfdt     = x[1];
+    source.amp      = x[2];
+    source.phi      = x[3];
+    source.costheta = x[4];
+    source.cosi     = x[5];
+    source.psi      = x[6];
+    source.phi0     = x[7];
+    source.d2fdt2   = (Ncol>8) ? x[8] : 0.0;
+    map_params_to_array(&source, params, data->T);
+}
+
+void print_source_params_binary(struct Data *data, struct Source *source, FILE *fptr)
+{
+    int Ncol = source_params_columns(source->NP);
+    
+    if(ftell(fptr)==0)
+    {
+        int header[2] = {Ncol, 0};
+        fwrite(CHAIN_BINARY_TAG, 1, 8, fptr);
+        fwrite(header, sizeof(int), 2, fptr);
+    }
+    
+    //map to parameter names (just to make code readable)
+    map_array_to_params(source, source->params, data->T);
+    
+    double x[9] = {source->f0, source->dfdt, source->amp, source->phi, source->costheta, source->cosi, source->psi, source->phi0, source->d2fdt2};
+    fwrite(x, sizeof(double), Ncol, fptr);
+}
+
+static int read_chain_file_binary(struct Data *data, char filename[], double **params)
+{
+    int fd = open(filename, O_RDONLY);
+    if(fd<0) return -1;
+    
+    struct stat st;
+    if(fstat(fd,&st)!=0 || st.st_size < CHAIN_BINARY_HEADER)
+    {
+        close(fd);
+        return -1;
+    }
+    
+    char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map==MAP_FAILED) return -1;
+    
+    if(memcmp(map, CHAIN_BINARY_TAG, 8)!=0)
+    {
+        munmap(map, st.st_size);
+        return -1;
+    }
+    
+    int Ncol;
+    memcpy(&Ncol, map+8, sizeof(int));
+    if(Ncol < source_params_columns(data->NP))
+    {
+        fprintf(stderr,"Error reading %s: %i columns for %i parameters\n",filename,Ncol,data->NP);
+        exit(1);
+    }
+    
+    int N = (int)((st.st_size - CHAIN_BINARY_HEADER)/(Ncol*sizeof(double)));
+    const double *record = (const double *)(map + CHAIN_BINARY_HEADER);
+    
+    for(int j=0; j<data->NP; j++) params[j] = malloc(N*sizeof(double));
+    
+    double x[data->NP];
+    for(int n=0; n<N; n++)
+    {
+        unpack_source_params(data, record + (size_t)n*Ncol, Ncol, x);
+        for(int j=0; j<data->NP; j++) params[j][n] = x[j];
+    }
+    
+    munmap(map, st.st_size);
+    
+    return N;
+}
+
+int read_chain_file(struct Data *data, char filename[], double **params)
+{
+    int N = read_chain_file_binary(data, filename, params);
+    if(N>=0) return N;
+    
+    FILE *fptr = fopen(filename,"r");
+    if(fptr==NULL)
+    {
+        fprintf(stderr,"Error opening %s\n",filename);
+        exit(1);
+    }
+    
+    //ASCII chain, grow the rows as samples are read
+    int Ncol = source_params_columns(data->NP);
+    int Nmax = 1024;
+    for(int j=0; j<data->NP; j++) params[j] = malloc(Nmax*sizeof(double));
+    
+    double x[9];
+    double p[data->NP];
+    N = 0;
+    while(1)
+    {
+        int check = 0;
+        for(int c=0; c<Ncol; c++) check += (fscanf(fptr,"%lg",&x[c])==1);
+        if(check<Ncol) break;
+        
+        if(N==Nmax)
+        {
+            Nmax *= 2;
+            for(int j=0; j<data->NP; j++) params[j] = realloc(params[j], Nmax*sizeof(double));
+        }
+        
+        unpack_source_params(data, x, Ncol, p);
+        for(int j=0; j<data->NP; j++) params[j][N] = p[j];
+        N++;
+    }
+    fclose(fptr);
+    
+    return N;
+}
+
 void save_waveforms(struct Data *data, struct Model *model, int mcmc)
 {
     int n_re,n_im;
@@ -94,6 +94,21 @@ void scan_calibration_state(struct Data *data, struct Model *model, FILE *fptr,
 ///@{
 void print_source_params(struct Data *data, struct Source *source, FILE *fptr);
 void scan_source_params(struct Data *data, struct Source *source, FILE *fptr);
+
+/// Binary version of print_source_params(), writes the header of Chain::parameterBinaryFile to empty files
+void print_source_params_binary(struct Data *data, struct Source *source, FILE *fptr);
+
+/**
+ \brief Read every source sample in a parameter chain file in a single pass
+ 
+ Binary files written by print_source_params_binary() are memory mapped.
+ Anything else is parsed as ASCII in the format of print_source_params().
+ Each of the Data::NP rows of `params` is allocated and filled with
+ Source::params of every sample.
+ 
+ @returns number of samples
+ */
+int read_chain_file(struct Data *data, char filename[], double **params);
 ///@}
 
 /**
@@ -194,7 +194,11 @@ void galactic_binary_mcmc(struct Orbit *orbit, struct Data *data, struct Model *
     struct Model *model_x = model;
     struct Model *model_y = trial;
     
-    copy_model(model_x,model_y);
+    /*
+     only source n changes, so model and likelihood can be updated
+     over its bandwidth. calibration and multiple segments touch every bin.
+     */
+    int delta = (!flags->prior && !flags->fullLogL && !flags->calibration && model_x->NT==1);
     
     //pick a source to update
     int n = (int)(gsl_rng_uniform(chain->r[ic])*(double)model_x->Nlive);
@@ -203,6 +207,13 @@ void galactic_binary_mcmc(struct Orbit *orbit, struct Data *data, struct Model *
     struct Source *source_x = model_x->source[n];
     struct Source *source_y = model_y->source[n];
     
+    /*
+     incremental updates only read source n from model_y,
+     the rest of the trial model is allowed to go stale
+     */
+    if(delta) copy_source(source_x,source_y);
+    else      copy_model(model_x,model_y);
+    
     
     //choose proposal distribution
     int trial_n;
@@ -217,6 +228,14 @@ void galactic_binary_mcmc(struct Orbit *orbit, struct Data *data, struct Model *
     }
     proposal[nprop]->trial[ic]++;
     
+    //time the move for tune_proposal_weights()
+    int tune = (flags->tuneProposals && flags->burnin);
+    int accept = 0;
+    double tstart = (tune) ? omp_get_wtime() : 0.0;
+    
+    //Fisher jumps are tracked per source to decide when the matrix needs updating
+    int fisher = (proposal[nprop]->function == &draw_from_fisher);
+    
     //call proposal function to update source parameters
     (*proposal[nprop]->function)(data, model_x, source_y, proposal[nprop], source_y->params, chain->r[ic]);
     
@@ -231,10 +250,6 @@ void galactic_binary_mcmc(struct Orbit *orbit, struct Data *data, struct Model *
     if(flags->fixFreq) source_y->params[0] = data->inj->f0*data->T;
     if(flags->fixFdot) source_y->params[7] = data->inj->dfdt*data->T*data->T;
     
-    //call associated proposal density functions
-    logQyx = (*proposal[nprop]->density)(data, model_x, source_y, proposal[nprop], source_y->params);
-    logQxy = (*proposal[nprop]->density)(data, model_x, source_x, proposal[nprop], source_x->params);
-        
     map_array_to_params(source_y, source_y->params, data->T);
 
     /*
@@ -243,61 +258,129 @@ void galactic_binary_mcmc(struct Orbit *orbit, struct Data *data, struct Model *
         maximize_signal_model(orbit, data, model_y, n);
      */
 
-    
-    //update calibration parameters
-    if(flags->calibration) draw_calibration_parameters(data, model_y, chain->r[ic]);
     /*
-     no proposal density for calibration parameters
-     because we are always drawing from prior...for now
+     Staged acceptance, cheapest rejections first:
+     1) prior support of y, before any proposal densities are computed
+     2) proposal densities and, with --delayed-accept, a screen using the
+        Fisher approximation to the likelihood of source n for local proposals
+     3) waveforms and full likelihood only for moves that survive
+     The second stage of the delayed acceptance divides out the Fisher
+     approximation so the chain still targets the full posterior.
      */
     
-    //TODO:copy params for segment 0 into higher segments
-    //copy_source(model_y->source[n],model_y->source[n]);
-    //map_params_to_array(model_y->source[n], model_y->source[n]->params, data->T);
-    
-    //get priors for x and y
-    logPx = evaluate_prior(flags, data, model_x, prior, source_x->params);
-    logPy = evaluate_prior(flags, data, model_y, prior, source_y->params);
-    
-    //add calibration source parameters
-    /*
-     no prior density for calibration parameters
-     because we are always drawing from prior...for now
-     */
+    //get prior for y (model_x holds the current noise model and prior ranges)
+    logPy = evaluate_prior(flags, data, model_x, prior, source_y->params);
     
     if(logPy > -INFINITY)
     {
-        if(!flags->prior)
+        //call associated proposal density functions
+        logQyx = (*proposal[nprop]->density)(data, model_x, source_y, proposal[nprop], source_y->params);
+        logQxy = (*proposal[nprop]->density)(data, model_x, source_x, proposal[nprop], source_x->params);
+        
+        //get prior for x
+        logPx = evaluate_prior(flags, data, model_x, prior, source_x->params);
+        
+        //update calibration parameters
+        if(flags->calibration) draw_calibration_parameters(data, model_y, chain->r[ic]);
+        /*
+         no proposal or prior density for calibration parameters
+         because we are always drawing from prior...for now
+         */
+        
+        //TODO:copy params for segment 0 into higher segments
+        //copy_source(model_y->source[n],model_y->source[n]);
+        //map_params_to_array(model_y->source[n], model_y->source[n]->params, data->T);
+        
+        logH += logPy  - logPx;  //priors
+        logH += logQxy - logQyx; //proposals
+        
+        /*
+         first stage of delayed acceptance with Fisher approximation to delta logL,
+         only for local proposals because the quadratic approximation is centered
+         on where the Fisher matrix was computed
+         */
+        int survive = 1;
+        if(flags->delayedAccept && !flags->prior && proposal[nprop]->local)
         {
-            //  Form master template
-            generate_signal_model(orbit, data, model_y, n);
+            double d2x, d2y;
             
-            //calibration error
-            if(flags->calibration)
+            //no screen until source n has a usable Fisher matrix
+            if(galactic_binary_fisher_distance(source_x, source_x->params, &d2x) &&
+               galactic_binary_fisher_distance(source_x, source_y->params, &d2y))
             {
-                generate_calibration_model(data, model_y);
-                apply_calibration_model(data, model_y);
+                double dlogLF = -0.5*(d2y - d2x)/chain->temperature[ic];
+                
+                logH += dlogLF;
+                loga = log(gsl_rng_uniform(chain->r[ic]));
+                survive = (isfinite(logH) && logH > loga);
+                
+                //second stage only corrects for the approximation
+                logH = -dlogLF;
             }
-            
-            //get likelihood for y
-            model_y->logL = gaussian_log_likelihood(data, model_y);
-            
-            /*
-             H = [p(d|y)/p(d|x)]/T x p(y)/p(x) x q(x|y)/q(y|x)
-             */
-            logH += (model_y->logL - model_x->logL)/chain->temperature[ic]; //delta logL
         }
-        logH += logPy  - logPx;  //priors
-        logH += logQxy - logQyx; //proposals
         
-        loga = log(gsl_rng_uniform(chain->r[ic]));
-        
-        if(isfinite(logH) && logH > loga)
+        if(survive)
         {
-            proposal[nprop]->accept[ic]++;
-            copy_model(model_y,model_x);
+            if(!flags->prior)
+            {
+                if(delta)
+                {
+                    //  Update master template over bandwidth of source n
+                    update_signal_model(orbit, data, model_x, model_y, n);
+                    
+                    //get likelihood for y
+                    model_y->logL = delta_gaussian_log_likelihood(data, model_x, model_y, n);
+                }
+                else
+                {
+                    //  Form master template
+                    generate_signal_model(orbit, data, model_y, n);
+                    
+                    //calibration error
+                    if(flags->calibration)
+                    {
+                        generate_calibration_model(data, model_y);
+                        apply_calibration_model(data, model_y);
+                    }
+                    
+                    //get likelihood for y
+                    model_y->logL = gaussian_log_likelihood(data, model_y);
+                }
+                
+                /*
+                 H = [p(d|y)/p(d|x)]/T x p(y)/p(x) x q(x|y)/q(y|x)
+                 */
+                logH += (model_y->logL - model_x->logL)/chain->temperature[ic]; //delta logL
+            }
+            
+            loga = log(gsl_rng_uniform(chain->r[ic]));
+            
+            if(isfinite(logH) && logH > loga)
+            {
+                proposal[nprop]->accept[ic]++;
+                if(delta) copy_model_source(data, model_y, model_x, n);
+                else      copy_model(model_y,model_x);
+                if(fisher) source_x->fisher_accept++;
+                accept = 1;
+            }
         }
     }
+    if(fisher) source_x->fisher_trial++;
+    
+    if(tune)
+    {
+        proposal[nprop]->tune_trial[ic]++;
+        proposal[nprop]->tune_accept[ic] += accept;
+        proposal[nprop]->tune_time[ic]   += omp_get_wtime() - tstart;
+    }
+    
+    //periodically validate incremental updates against full likelihood calculation
+    if(delta)
+    {
+        chain->nupdate[ic]++;
+        if(flags->checkLogL && chain->nupdate[ic]%flags->checkLogL==0)
+            check_delta_log_likelihood(orbit, data, model_x, n);
+    }
 }
 
 void galactic_binary_rjmcmc(struct Orbit *orbit, struct Data *data, struct Model *model, struct Model *trial, struct Chain *chain, struct Flags *flags, struct Prior *prior, struct Proposal **proposal, int ic)
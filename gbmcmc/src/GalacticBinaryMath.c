@@ -20,12 +20,19 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_eigen.h>
 #include <gsl/gsl_sf.h>
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_real.h>
+
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#endif
 
 #include <LISA.h>
 
@@ -460,3 +467,80 @@ void cholesky_decomp(double **A, double **L, int N)
     
 }
 
+#ifdef HAVE_FFTW3
+
+/* largest power of two with a cached complex plan */
+#define FFT_PLAN_CACHE_SIZE 32
+
+/* one plan table per thread; the FFTW planner itself is not thread safe */
+static fftw_plan complex_fft_plan[FFT_PLAN_CACHE_SIZE] = {NULL};
+#pragma omp threadprivate(complex_fft_plan)
+
+static fftw_plan get_complex_fft_plan(int n)
+{
+    int k = (int)log2((double)n);
+    if(complex_fft_plan[k] == NULL)
+    {
+        fftw_complex *buffer = fftw_malloc(n*sizeof(fftw_complex));
+        #pragma omp critical(fftw_planner)
+        complex_fft_plan[k] = fftw_plan_dft_1d(n, buffer, buffer, FFTW_FORWARD, FFTW_ESTIMATE | FFTW_UNALIGNED);
+        fftw_free(buffer);
+    }
+    return complex_fft_plan[k];
+}
+
+void complex_fft_forward(double **data, int n, int howmany)
+{
+    fftw_plan plan = get_complex_fft_plan(n);
+    for(int m=0; m<howmany; m++) fftw_execute_dft(plan, (fftw_complex *)data[m], (fftw_complex *)data[m]);
+}
+
+void real_fft_forward(double **data, int n, int howmany)
+{
+    double *in = fftw_malloc(n*sizeof(double));
+    fftw_complex *out = fftw_malloc((n/2+1)*sizeof(fftw_complex));
+    
+    fftw_plan plan;
+    #pragma omp critical(fftw_planner)
+    plan = fftw_plan_dft_r2c_1d(n, in, out, FFTW_ESTIMATE);
+    
+    for(int m=0; m<howmany; m++)
+    {
+        memcpy(in, data[m], n*sizeof(double));
+        fftw_execute(plan);
+        
+        //repack into GSL halfcomplex order
+        data[m][0] = out[0][0];
+        for(int i=1; i<(n+1)/2; i++)
+        {
+            data[m][2*i-1] = out[i][0];
+            data[m][2*i]   = out[i][1];
+        }
+        if(n%2==0) data[m][n-1] = out[n/2][0];
+    }
+    
+    #pragma omp critical(fftw_planner)
+    fftw_destroy_plan(plan);
+    fftw_free(in);
+    fftw_free(out);
+}
+
+#else
+
+void complex_fft_forward(double **data, int n, int howmany)
+{
+    for(int m=0; m<howmany; m++) gsl_fft_complex_radix2_forward(data[m], 1, n);
+}
+
+void real_fft_forward(double **data, int n, int howmany)
+{
+    gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(n);
+    gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
+    
+    for(int m=0; m<howmany; m++) gsl_fft_real_transform(data[m], 1, n, real, work);
+    
+    gsl_fft_real_wavetable_free(real);
+    gsl_fft_real_workspace_free(work);
+}
+
+#endif
@@ -174,6 +174,35 @@ void matrix_multiply(double **A, double **B, double **AB, int N);
  */
 void cholesky_decomp(double **A, double **L, int N);
 
+/**
+ @name Fourier transforms
+ 
+ Built against FFTW3 when `HAVE_FFTW3` is defined, with one cached plan per size
+ and thread.  Otherwise wraps the `GSL` FFT routines.
+ Both use the \f$ e^{-2\pi i jk/n} \f$ sign convention and do not normalize.
+ */
+///@{
+/**
+ \brief In-place forward FFT of howmany complex arrays
+ 
+ @param[in,out] data `howmany` arrays of `n` interleaved (re,im) samples
+ @param[in] n number of complex samples, a power of 2
+ @param[in] howmany number of arrays
+ */
+void complex_fft_forward(double **data, int n, int howmany);
+
+/**
+ \brief In-place forward FFT of howmany real arrays
+ 
+ Output is in the `GSL` halfcomplex format \f$ [r_0, r_1, i_1, r_2, i_2, ...] \f$
+ 
+ @param[in,out] data `howmany` arrays of `n` real samples
+ @param[in] n number of samples, any length
+ @param[in] howmany number of arrays
+ */
+void real_fft_forward(double **data, int n, int howmany);
+///@}
+
 
 
 #endif /* GalacticBinaryMath_h */
@@ -35,6 +35,7 @@
 #include "GalacticBinaryFStatistic.h"
 
 #define FIXME 0
+#define LOGL_TOLERANCE 1e-6 /* allowed difference between incremental and full logL */
 
 void map_array_to_params(struct Source *source, double *params, double T)
 {
@@ -143,9 +144,11 @@ void alloc_data(struct Data *data, struct Flags *flags)
     
     //Spectrum proposal
     data->p = calloc(data->N,sizeof(double));
+    data->pcdf = calloc(data->N+1,sizeof(double));
 
     //catalog of previously detected sources
     data->catalog = malloc(sizeof(struct Catalog));
+    data->catalog->gmm = NULL;
 
 }
 
@@ -180,6 +183,7 @@ void initialize_chain(struct Chain *chain, struct Flags *flags, long *seed, cons
     chain->acceptance = calloc(NC,sizeof(double));
     chain->temperature = calloc(NC,sizeof(double));
     chain->avgLogL     = calloc(NC,sizeof(double));
+    chain->nupdate     = calloc(NC,sizeof(int));
     chain->dimension   = calloc(NC,sizeof(int *));
     for(ic=0; ic<NC; ic++)
     {
@@ -223,6 +227,9 @@ void initialize_chain(struct Chain *chain, struct Flags *flags, long *seed, cons
     sprintf(filename,"%s/chains/parameter_chain.dat.0",flags->runDir);
     chain->parameterFile[0] = fopen(filename,mode);
     
+    sprintf(filename,"%s/chains/parameter_chain.bin",flags->runDir);
+    chain->parameterBinaryFile = fopen(filename,mode);
+    
     chain->dimensionFile = malloc(flags->DMAX*sizeof(FILE *));
     for(int i=0; i<flags->DMAX; i++)
     {
@@ -262,7 +269,8 @@ void free_chain(struct Chain *chain, struct Flags *flags)
     free(chain->index);
     free(chain->acceptance);
     free(chain->temperature);
-    free(chain->avgLogL);    
+    free(chain->avgLogL);
+    free(chain->nupdate);
     for(int ic=0; ic<chain->NC; ic++)
     {
         gsl_rng_free(chain->r[ic]);
@@ -281,6 +289,7 @@ void free_chain(struct Chain *chain, struct Flags *flags)
     fclose(chain->chainFile[0]);
 
     fclose(chain->parameterFile[0]);
+    fclose(chain->parameterBinaryFile);
     
     for(int i=0; i<flags->DMAX; i++)
     {
@@ -356,6 +365,15 @@ void alloc_model(struct Model *model, int Nmax, int NFFT, int Nchannel, int NP,
     for(n=0; n<NP; n++) model->prior[n] = calloc(2,sizeof(double));
 }
 
+/* union of bandwidths covered by two versions of the same source, clipped to the segment */
+static void source_footprint(struct Source *a, struct Source *b, int N, int *imin, int *imax)
+{
+    *imin = (a->imin < b->imin) ? a->imin : b->imin;
+    *imax = (a->imax > b->imax) ? a->imax : b->imax;
+    if(*imin < 0) *imin = 0;
+    if(*imax > N) *imax = N;
+}
+
 void copy_model(struct Model *origin, struct Model *copy)
 {
     //Source parameters
@@ -363,7 +381,9 @@ void copy_model(struct Model *origin, struct Model *copy)
     copy->NP             = origin->NP;
     copy->Nmax           = origin->Nmax;
     copy->Nlive          = origin->Nlive;
-    for(int n=0; n<origin->Nmax; n++)
+    
+    //sources beyond Nlive are regenerated from scratch when they are born
+    for(int n=0; n<origin->Nlive; n++)
         copy_source(origin->source[n],copy->source[n]);
     
     for(int n=0; n<origin->NT; n++)
@@ -398,6 +418,34 @@ void copy_model(struct Model *origin, struct Model *copy)
     copy->logLnorm       = origin->logLnorm;
 }
 
+void copy_model_source(struct Data *data, struct Model *origin, struct Model *copy, int source_id)
+{
+    int imin,imax;
+    source_footprint(origin->source[source_id], copy->source[source_id], data->N, &imin, &imax);
+    
+    size_t offset = 2*imin;
+    size_t size   = (imax>imin) ? 2*(imax-imin)*sizeof(double) : 0;
+    
+    for(int n=0; n<origin->NT; n++)
+    {
+        //TDI
+        memcpy(copy->tdi[n]->X+offset, origin->tdi[n]->X+offset, size);
+        memcpy(copy->tdi[n]->A+offset, origin->tdi[n]->A+offset, size);
+        memcpy(copy->tdi[n]->E+offset, origin->tdi[n]->E+offset, size);
+        
+        //Residual
+        memcpy(copy->residual[n]->X+offset, origin->residual[n]->X+offset, size);
+        memcpy(copy->residual[n]->A+offset, origin->residual[n]->A+offset, size);
+        memcpy(copy->residual[n]->E+offset, origin->residual[n]->E+offset, size);
+    }
+    
+    //Source parameters
+    copy_source(origin->source[source_id],copy->source[source_id]);
+    
+    //Model likelihood
+    copy->logL = origin->logL;
+}
+
 int compare_model(struct Model *a, struct Model *b)
 {
     
@@ -569,12 +617,19 @@ void alloc_noise(struct Noise *noise, int NFFT)
     noise->SnE = calloc(NFFT,sizeof(double));
     noise->SnX = calloc(NFFT,sizeof(double));
     
+    noise->invSnA = calloc(NFFT,sizeof(double));
+    noise->invSnE = calloc(NFFT,sizeof(double));
+    noise->invSnX = calloc(NFFT,sizeof(double));
+    
     int n;
     for(n=0; n<NFFT; n++)
     {
         noise->SnA[n]=1.0;
         noise->SnE[n]=1.0;
         noise->SnX[n]=1.0;
+        noise->invSnA[n]=1.0;
+        noise->invSnE[n]=1.0;
+        noise->invSnX[n]=1.0;
     }
 }
 
@@ -585,12 +640,18 @@ void realloc_noise(struct Noise *noise, int NFFT)
     noise->SnA = realloc(noise->SnA,NFFT*sizeof(double));
     noise->SnE = realloc(noise->SnE,NFFT*sizeof(double));
     noise->SnX = realloc(noise->SnX,NFFT*sizeof(double));
+    noise->invSnA = realloc(noise->invSnA,NFFT*sizeof(double));
+    noise->invSnE = realloc(noise->invSnE,NFFT*sizeof(double));
+    noise->invSnX = realloc(noise->invSnX,NFFT*sizeof(double));
 
     for(int n=0; n<NFFT; n++)
     {
         noise->SnA[n]=1.0;
         noise->SnE[n]=1.0;
         noise->SnX[n]=1.0;
+        noise->invSnA[n]=1.0;
+        noise->invSnE[n]=1.0;
+        noise->invSnX[n]=1.0;
     }
 
 }
@@ -605,6 +666,19 @@ void copy_noise(struct Noise *origin, struct Noise *copy)
     memcpy(copy->SnX, origin->SnX, origin->N*sizeof(double));
     memcpy(copy->SnA, origin->SnA, origin->N*sizeof(double));
     memcpy(copy->SnE, origin->SnE, origin->N*sizeof(double));
+    memcpy(copy->invSnX, origin->invSnX, origin->N*sizeof(double));
+    memcpy(copy->invSnA, origin->invSnA, origin->N*sizeof(double));
+    memcpy(copy->invSnE, origin->invSnE, origin->N*sizeof(double));
+}
+
+void invert_noise(struct Noise *noise)
+{
+    for(int n=0; n<noise->N; n++)
+    {
+        noise->invSnA[n] = 1./noise->SnA[n];
+        noise->invSnE[n] = 1./noise->SnE[n];
+        noise->invSnX[n] = 1./noise->SnX[n];
+    }
 }
 
 void free_noise(struct Noise *noise)
@@ -613,6 +687,9 @@ void free_noise(struct Noise *noise)
     free(noise->SnA);
     free(noise->SnE);
     free(noise->SnX);
+    free(noise->invSnA);
+    free(noise->invSnE);
+    free(noise->invSnX);
     free(noise);
 }
 
@@ -699,11 +776,14 @@ void alloc_source(struct Source *source, int NFFT, int Nchannel, int NP)
     source->fisher_matrix = malloc(NP*sizeof(double *));
     source->fisher_evectr = malloc(NP*sizeof(double *));
     source->fisher_evalue = calloc(NP,sizeof(double));
+    source->fisher_params = calloc(NP,sizeof(double));
     for(int i=0; i<NP; i++)
     {
         source->fisher_matrix[i] = calloc(NP,sizeof(double));
         source->fisher_evectr[i] = calloc(NP,sizeof(double));
     }
+    source->fisher_trial  = 0;
+    source->fisher_accept = 0;
 };
 
 void copy_source(struct Source *origin, struct Source *copy)
@@ -730,6 +810,19 @@ void copy_source(struct Source *origin, struct Source *copy)
     copy->dfdt   = origin->dfdt;
     copy->d2fdt2 = origin->d2fdt2;
     
+    /*
+     Response is only filled over the first BW bins and zero elsewhere,
+     so covering both bandwidths is a full copy of X,A,E
+     */
+    int N = (origin->tdi->N < copy->tdi->N) ? origin->tdi->N : copy->tdi->N;
+    int BW = (origin->BW > copy->BW) ? origin->BW : copy->BW;
+    if(BW > N) BW = N;
+    
+    copy->tdi->Nchannel = origin->tdi->Nchannel;
+    memcpy(copy->tdi->X, origin->tdi->X, 2*BW*sizeof(double));
+    memcpy(copy->tdi->A, origin->tdi->A, 2*BW*sizeof(double));
+    memcpy(copy->tdi->E, origin->tdi->E, 2*BW*sizeof(double));
+
     //Book-keeping
     copy->BW   = origin->BW;
     copy->qmin = origin->qmin;
@@ -737,12 +830,12 @@ void copy_source(struct Source *origin, struct Source *copy)
     copy->imin = origin->imin;
     copy->imax = origin->imax;
     
-    //Response
-    copy_tdi(origin->tdi,copy->tdi);
-    
     //Fisher
     memcpy(copy->fisher_evalue, origin->fisher_evalue, origin->NP*sizeof(double));
+    memcpy(copy->fisher_params, origin->fisher_params, origin->NP*sizeof(double));
     memcpy(copy->params, origin->params, origin->NP*sizeof(double));
+    copy->fisher_trial  = origin->fisher_trial;
+    copy->fisher_accept = origin->fisher_accept;
 
     for(int i=0; i<origin->NP; i++)
     {
@@ -763,6 +856,7 @@ void free_source(struct Source *source)
     free(source->fisher_matrix);
     free(source->fisher_evectr);
     free(source->fisher_evalue);
+    free(source->fisher_params);
     free(source->params);
     
     free_tdi(source->tdi);
@@ -770,6 +864,15 @@ void free_source(struct Source *source)
     free(source);
 }
 
+void update_fisher_matrices(struct Orbit *orbit, struct Data *data, struct Model *model, double temperature)
+{
+    for(int n=0; n<model->Nlive; n++)
+    {
+        if(galactic_binary_fisher_stale(model->source[n], temperature))
+            galactic_binary_fisher(orbit, data, model->source[n], data->noise[FIXME]);
+    }
+}
+
 void generate_signal_model(struct Orbit *orbit, struct Data *data, struct Model *model, int source_id)
 {
     int i,j,n,m;
@@ -840,6 +943,87 @@ void generate_signal_model(struct Orbit *orbit, struct Data *data, struct Model
     }//loop over sources
 }
 
+void update_signal_model(struct Orbit *orbit, struct Data *data, struct Model *model_x, struct Model *model_y, int source_id)
+{
+    int i,j,imin,imax;
+    int i_re,i_im,j_re,j_im;
+    
+    struct Source *source_x = model_x->source[source_id];
+    struct Source *source_y = model_y->source[source_id];
+    struct TDI *tdi = model_y->tdi[FIXME];
+    
+    //Only the first BW bins of the source response are ever filled
+    for(i=0; i<2*source_y->BW && i<2*data->N; i++)
+    {
+        source_y->tdi->X[i]=0.0;
+        source_y->tdi->A[i]=0.0;
+        source_y->tdi->E[i]=0.0;
+    }
+    
+    map_array_to_params(source_y, source_y->params, data->T);
+    
+    //Book-keeping of injection time-frequency volume
+    galactic_binary_alignment(orbit, data, source_y);
+    
+    //Simulate gravitational wave signal
+    galactic_binary(orbit, data->format, data->T, model_y->t0[FIXME], source_y->params, source_y->NP, source_y->tdi->X, source_y->tdi->A, source_y->tdi->E, source_y->BW, source_y->tdi->Nchannel);
+    
+    //Start from current meta template over both bandwidths
+    source_footprint(source_x, source_y, data->N, &imin, &imax);
+    for(i=2*imin; i<2*imax; i++)
+    {
+        tdi->X[i] = model_x->tdi[FIXME]->X[i];
+        tdi->A[i] = model_x->tdi[FIXME]->A[i];
+        tdi->E[i] = model_x->tdi[FIXME]->E[i];
+    }
+    
+    //Remove current waveform from meta template
+    for(i=0; i<source_x->BW; i++)
+    {
+        j = i+source_x->imin;
+        
+        if(j>-1 && j<data->N)
+        {
+            i_re = 2*i;
+            i_im = i_re+1;
+            j_re = 2*j;
+            j_im = j_re+1;
+            
+            tdi->X[j_re] -= source_x->tdi->X[i_re];
+            tdi->X[j_im] -= source_x->tdi->X[i_im];
+            
+            tdi->A[j_re] -= source_x->tdi->A[i_re];
+            tdi->A[j_im] -= source_x->tdi->A[i_im];
+            
+            tdi->E[j_re] -= source_x->tdi->E[i_re];
+            tdi->E[j_im] -= source_x->tdi->E[i_im];
+        }
+    }
+    
+    //Add new waveform to meta template
+    for(i=0; i<source_y->BW; i++)
+    {
+        j = i+source_y->imin;
+        
+        if(j>-1 && j<data->N)
+        {
+            i_re = 2*i;
+            i_im = i_re+1;
+            j_re = 2*j;
+            j_im = j_re+1;
+            
+            tdi->X[j_re] += source_y->tdi->X[i_re];
+            tdi->X[j_im] += source_y->tdi->X[i_im];
+            
+            tdi->A[j_re] += source_y->tdi->A[i_re];
+            tdi->A[j_im] += source_y->tdi->A[i_im];
+            
+            tdi->E[j_re] += source_y->tdi->E[i_re];
+            tdi->E[j_im] += source_y->tdi->E[i_im];
+        }
+    }
+}
+
 void generate_power_law_noise_model(struct Data *data, struct Model *model)
 {
     struct Noise *noise = NULL;
@@ -869,6 +1053,7 @@ void generate_power_law_noise_model(struct Data *data, struct Model *model)
             default:
                 break;
         }
+        invert_noise(noise);
     }
     
 }
@@ -892,6 +1077,7 @@ void generate_noise_model(struct Data *data, struct Model *model)
             default:
                 break;
         }
+        invert_noise(model->noise[m]);
     }
 }
 
@@ -1039,6 +1225,29 @@ void maximize_signal_model(struct Orbit *orbit, struct Data *data, struct Model
         free(Fparams);
     }
 }
+/*
+ Residual r = d-h and noise weighted inner product (r|r) in one pass,
+ using the cached inverse noise spectrum.
+ */
+static double residual_nwip(double *d, double *h, double *r, double *invSn, int N)
+{
+    double arg = 0.0;
+    
+    #pragma omp simd reduction(+:arg)
+    for(int i=0; i<N; i++)
+    {
+        double r_re = d[2*i]   - h[2*i];
+        double r_im = d[2*i+1] - h[2*i+1];
+        
+        r[2*i]   = r_re;
+        r[2*i+1] = r_im;
+        
+        arg += (r_re*r_re + r_im*r_im)*invSn[i];
+    }
+    
+    return(2.0*arg);
+}
+
 double gaussian_log_likelihood(struct Data *data, struct Model *model)
 {
     
@@ -1048,37 +1257,160 @@ double gaussian_log_likelihood(struct Data *data, struct Model *model)
     *
     */
     
-    int N2 = data->N*2;
     double logL = 0.0;
     
     //loop over time segments
     for(int n=0; n<model->NT; n++)
     {
         struct TDI *residual = model->residual[n];
+        struct Noise *noise = model->noise[n];
         
-        for(int i=0; i<N2; i++)
+        switch(data->Nchannel)
         {
-            residual->X[i] = data->tdi[n]->X[i] - model->tdi[n]->X[i];
-            residual->A[i] = data->tdi[n]->A[i] - model->tdi[n]->A[i];
-            residual->E[i] = data->tdi[n]->E[i] - model->tdi[n]->E[i];
+            case 1:
+                logL += -0.5*residual_nwip(data->tdi[n]->X, model->tdi[n]->X, residual->X, noise->invSnX, data->N);
+                break;
+            case 2:
+                logL += -0.5*residual_nwip(data->tdi[n]->A, model->tdi[n]->A, residual->A, noise->invSnA, data->N);
+                logL += -0.5*residual_nwip(data->tdi[n]->E, model->tdi[n]->E, residual->E, noise->invSnE, data->N);
+                break;
+            default:
+                fprintf(stderr,"Unsupported number of channels in gaussian_log_likelihood()\n");
+                exit(1);
         }
+    }
+    
+    return logL;
+}
+
+/*
+ Change in noise weighted inner product (r|r) over bins [imin,imax)
+ going from residual d-h_x to d-h_y. New residual is stored in r.
+ */
+static double delta_residual_nwip(double *d, double *h_x, double *h_y, double *r, double *invSn, int imin, int imax)
+{
+    int i_re,i_im;
+    double rx_re,rx_im;
+    double arg = 0.0;
+    
+    for(int i=imin; i<imax; i++)
+    {
+        i_re = 2*i;
+        i_im = i_re+1;
+        
+        rx_re = d[i_re] - h_x[i_re];
+        rx_im = d[i_im] - h_x[i_im];
+        
+        r[i_re] = d[i_re] - h_y[i_re];
+        r[i_im] = d[i_im] - h_y[i_im];
+        
+        arg += (r[i_re]*r[i_re] + r[i_im]*r[i_im] - rx_re*rx_re - rx_im*rx_im)*invSn[i];
+    }
+    
+    return(2.0*arg);
+}
+
+double delta_gaussian_log_likelihood(struct Data *data, struct Model *model_x, struct Model *model_y, int source_id)
+{
+    struct Source *source_x = model_x->source[source_id];
+    struct Source *source_y = model_y->source[source_id];
+    
+    //union of old and new waveform footprints
+    int imin,imax;
+    source_footprint(source_x, source_y, data->N, &imin, &imax);
+    
+    double dlogL = 0.0;
+    
+    //loop over time segments
+    for(int n=0; n<model_x->NT && imin<imax; n++)
+    {
+        struct TDI *d = data->tdi[n];
+        struct TDI *h_x = model_x->tdi[n];
+        struct TDI *h_y = model_y->tdi[n];
+        struct TDI *residual = model_y->residual[n];
+        struct Noise *noise = model_x->noise[n];
         
         switch(data->Nchannel)
         {
             case 1:
-                logL += -0.5*fourier_nwip(residual->X, residual->X, model->noise[n]->SnX, data->N);
+                dlogL += -0.5*delta_residual_nwip(d->X, h_x->X, h_y->X, residual->X, noise->invSnX, imin, imax);
                 break;
             case 2:
-                logL += -0.5*fourier_nwip(residual->A, residual->A, model->noise[n]->SnA, data->N);
-                logL += -0.5*fourier_nwip(residual->E, residual->E, model->noise[n]->SnE, data->N);
+                dlogL += -0.5*delta_residual_nwip(d->A, h_x->A, h_y->A, residual->A, noise->invSnA, imin, imax);
+                dlogL += -0.5*delta_residual_nwip(d->E, h_x->E, h_y->E, residual->E, noise->invSnE, imin, imax);
                 break;
             default:
-                fprintf(stderr,"Unsupported number of channels in gaussian_log_likelihood()\n");
+                fprintf(stderr,"Unsupported number of channels in delta_gaussian_log_likelihood()\n");
                 exit(1);
         }
     }
     
-    return logL;
+    return model_x->logL + dlogL;
+}
+
+/*
+ Change in noise weighted inner product (r|r) over bins [imin,imax)
+ when the data change from d to d-dd. New residual is stored in r.
+ */
+static double data_delta_residual_nwip(double *d, double *dd, double *h, double *r, double *invSn, int imin, int imax)
+{
+    double arg = 0.0;
+    
+    for(int i=imin; i<imax; i++)
+    {
+        int i_re = 2*i;
+        int i_im = i_re+1;
+        
+        double rx_re = d[i_re] - h[i_re];
+        double rx_im = d[i_im] - h[i_im];
+        
+        r[i_re] = rx_re - dd[i_re];
+        r[i_im] = rx_im - dd[i_im];
+        
+        arg += (r[i_re]*r[i_re] + r[i_im]*r[i_im] - rx_re*rx_re - rx_im*rx_im)*invSn[i];
+    }
+    
+    return(2.0*arg);
+}
+
+double data_delta_gaussian_log_likelihood(struct Data *data, struct Model *model, struct TDI *delta, int imin, int imax)
+{
+    struct TDI *d = data->tdi[FIXME];
+    struct TDI *h = model->tdi[FIXME];
+    struct TDI *residual = model->residual[FIXME];
+    struct Noise *noise = model->noise[FIXME];
+    
+    double dlogL = 0.0;
+    
+    switch(data->Nchannel)
+    {
+        case 1:
+            dlogL += -0.5*data_delta_residual_nwip(d->X, delta->X, h->X, residual->X, noise->invSnX, imin, imax);
+            break;
+        case 2:
+            dlogL += -0.5*data_delta_residual_nwip(d->A, delta->A, h->A, residual->A, noise->invSnA, imin, imax);
+            dlogL += -0.5*data_delta_residual_nwip(d->E, delta->E, h->E, residual->E, noise->invSnE, imin, imax);
+            break;
+        default:
+            fprintf(stderr,"Unsupported number of channels in data_delta_gaussian_log_likelihood()\n");
+            exit(1);
+    }
+    
+    return model->logL + dlogL;
+}
+
+void check_delta_log_likelihood(struct Orbit *orbit, struct Data *data, struct Model *model, int source_id)
+{
+    double logL = model->logL;
+    
+    //rebuild meta template from scratch, which also clears accumulated round-off
+    generate_signal_model(orbit, data, model, source_id);
+    model->logL = gaussian_log_likelihood(data, model);
+    
+    if(fabs(model->logL - logL) > LOGL_TOLERANCE)
+    {
+        fprintf(stderr,"Warning: incremental logL=%.12g differs from full logL=%.12g (source %i)\n",logL,model->logL,source_id);
+    }
 }
 
 double gaussian_log_likelihood_constant_norm(struct Data *data, struct Model *model)
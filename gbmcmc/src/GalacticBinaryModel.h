@@ -28,6 +28,15 @@
 
 #include <stdio.h>
 
+/**
+\brief Recompute stale Fisher matrices
+
+ Calls galactic_binary_fisher() for each live source in `model` where
+ galactic_binary_fisher_stale() says the current matrix no longer describes
+ the source's neighborhood at chain `temperature`.
+ */
+void update_fisher_matrices(struct Orbit *orbit, struct Data *data, struct Model *model, double temperature);
+
 /**
 \brief Create galactic binary model waveform
 
@@ -36,6 +45,17 @@
  */
 void generate_signal_model(struct Orbit *orbit, struct Data *data, struct Model *model, int source_id);
 
+/**
+\brief Update galactic binary model waveform for a single source
+
+ Computes the waveform for source `source_id` of `model_y`, then fills
+ Model::tdi of `model_y` with the meta template of `model_x` after swapping
+ in the new waveform, only touching the bandwidth of either version of the source.
+ The rest of `model_y` is not read, so it does not need to be a copy of `model_x`.
+ Only supports a single time segment.
+ */
+void update_signal_model(struct Orbit *orbit, struct Data *data, struct Model *model_x, struct Model *model_y, int source_id);
+
 /**
 \brief F-statistic maximization of galactic binary parameters
 
@@ -77,6 +97,33 @@ void apply_calibration_model(struct Data *data, struct Model *model);
  */
 double gaussian_log_likelihood(struct Data *data, struct Model *model);
 
+/**
+ \brief Compute Gaussian likelihood after update_signal_model()
+ 
+ Forms the residual only over the union of the old and new bandwidth of source `source_id`
+ and updates Model::logL of `model_x` by the change in the noise weighted inner product.
+ @return \f$ \log L_x -\frac{1}{2}\left[(d-h_y|d-h_y) - (d-h_x|d-h_x)\right] \f$
+ */
+double delta_gaussian_log_likelihood(struct Data *data, struct Model *model_x, struct Model *model_y, int source_id);
+
+/**
+ \brief Compute Gaussian likelihood before the data change by `-delta` over bins [`imin`,`imax`)
+ 
+ Used when sources outside of the model, e.g. from neighboring segments, are subtracted
+ from Data::tdi. Updates the residual of `model` over the changed bins, but not the data.
+ @return \f$ \log L -\frac{1}{2}\left[(d-\delta-h|d-\delta-h) - (d-h|d-h)\right] \f$
+ */
+double data_delta_gaussian_log_likelihood(struct Data *data, struct Model *model, struct TDI *delta, int imin, int imax);
+
+/**
+ \brief Validate incremental likelihood against full calculation
+ 
+ Rebuilds the meta template and likelihood of `model` with generate_signal_model() and
+ gaussian_log_likelihood(), warning if the result differs from the stored Model::logL,
+ which is otherwise accumulated by delta_gaussian_log_likelihood().
+ */
+void check_delta_log_likelihood(struct Orbit *orbit, struct Data *data, struct Model *model, int source_id);
+
 /**
  \brief Compute normalization of Gaussian likelihood for constant noise level
  
@@ -142,6 +189,23 @@ void copy_noise(struct Noise *origin, struct Noise *copy);
 void copy_calibration(struct Calibration *origin, struct Calibration *copy);
 ///@}
 
+/**
+ \brief Refresh cached inverse noise spectra Noise::invSnA, Noise::invSnE, Noise::invSnX
+ 
+ Must be called whenever Noise::SnA, Noise::SnE, or Noise::SnX are changed
+ other than through generate_noise_model() or copy_noise().
+ */
+void invert_noise(struct Noise *noise);
+
+/**
+ \brief Copy single-source update between models
+ 
+ Copies source `source_id` and the Model::tdi and Model::residual bins
+ spanned by either version of that source, plus Model::logL.
+ Used in place of copy_model() after update_signal_model().
+ */
+void copy_model_source(struct Data *data, struct Model *origin, struct Model *copy, int source_id);
+
 /** @name Free memory for structures */
 ///@{
 void free_noise(struct Noise *noise);
@@ -508,67 +508,7 @@ int check_range(double *params, double **uniform_prior, int NP)
 
 void set_gmm_prior(struct Flags *flags, struct Data *data, struct Prior *prior)
 {
-    prior->gmm = data->catalog->entry[0]->gmm;
-}
-
-double evaluate_gmm_prior(struct Data *data, struct GMM *gmm, double *params)
-{
-    size_t NP = data->NP;
-    gsl_vector *x = gsl_vector_alloc(NP);
-    
-    /* pointers to GMM contents */
-    struct MVG **modes = gmm->modes;
-    size_t NMODES = gmm->NMODE;
-    
-
-    //pack parameters into gsl_vector with correct units
-    struct Source *source = malloc(sizeof(struct Source));
-    alloc_source(source, data->N, data->Nchannel, data->NP);
-    
-    map_array_to_params(source, params, data->T);
-    gsl_vector_set(x,0,source->f0);
-    gsl_vector_set(x,1,source->costheta);
-    gsl_vector_set(x,2,source->phi);
-    gsl_vector_set(x,3,log(source->amp));
-    gsl_vector_set(x,4,source->cosi);
-    gsl_vector_set(x,5,source->psi);
-    gsl_vector_set(x,6,source->phi0);
-    if(NP>7)
-        gsl_vector_set(x,7,source->dfdt);
-    if(NP>8)
-        gsl_vector_set(x,8,source->d2fdt2);
-
-    //map parameters to R
-    double xmin,xmax,xn,yn, logJ = 0;
-    for(size_t n=0; n<NP; n++)
-    {
-        xmin = gsl_matrix_get(modes[0]->minmax,n,0);
-        xmax = gsl_matrix_get(modes[0]->minmax,n,1);
-        xn = gsl_vector_get(x,n);
-        if(xn < xmin || xn >= xmax)
-        {            
-            //clean up
-            gsl_vector_free(x);
-            free_source(source);
-            return -INFINITY;
-        }
-        yn = logit(xn,xmin,xmax);
-        gsl_vector_set(x,n,yn);
-        
-        //Jacobian
-        logJ -= log(dsigmoid(yn, xmin, xmax));
-    }
-    
-    //sum over modes
-    double P=0.0;
-    for(size_t k=0; k<NMODES; k++)
-        P += modes[k]->p*multivariate_gaussian(x,modes[k]);
-    
-    //clean up
-    gsl_vector_free(x);
-    free_source(source);
-    
-    return log(P) + logJ;
+    prior->gmm_entry = 0;
 }
 
 double evaluate_prior(struct Flags *flags, struct Data *data, struct Model *model, struct Prior *prior, double *params)
@@ -580,7 +520,7 @@ double evaluate_prior(struct Flags *flags, struct Data *data, struct Model *mode
     if(check_range(params, uniform_prior, model->NP)) return -INFINITY;
 
     //update from existing runs prior
-    if(flags->update) logP = evaluate_gmm_prior(data, prior->gmm, params);
+    if(flags->update) logP = catalog_gmm_entry_density(data->catalog->gmm, prior->gmm_entry, params, data->T);
     
     //blind search prior
     else
@@ -76,8 +76,8 @@ struct Prior
     double ***tensor;//!<utility 3D array for prior metadata
     ///@}
 
-    /// Gaussian Mixture Model prior
-    struct GMM *gmm;
+    /// Gaussian Mixture Model prior, entry of flattened Catalog::gmm
+    int gmm_entry;
 };
 /**
  \brief Checks that parameters \f$\vec x\f$ are within prior volume \f$V\f$.
@@ -99,6 +99,8 @@ void set_galaxy_prior(struct Flags *flags, struct Prior *prior);
 
 /**
 \brief Sets Gaussian Mixture Model prior for source model
+ 
+ Selects the entry of the flattened Catalog::gmm used by evaluate_prior()
  */
 void set_gmm_prior(struct Flags *flags, struct Data *data, struct Prior *prior);
 
@@ -147,7 +149,6 @@ double evalaute_sky_location_prior(double *params, double **uniform_prior, doubl
  @returns \f$ \log p({\vec x})\f$
  */
 double evaluate_uniform_priors(double *params, double **uniform_prior, double *logPriorVolume, int NP);
-double evaluate_gmm_prior(struct Data *data, struct GMM *gmm, double *params);
 
 
 
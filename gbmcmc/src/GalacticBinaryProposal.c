@@ -20,6 +20,7 @@
 
 #include <math.h>
 #include <string.h>
+#include <omp.h>
 
 #include <gsl/gsl_blas.h>
 
@@ -52,6 +53,52 @@
 #define SNRCAP 10000.0 /* SNR cap on logL */
 
 
+/*
+ Tables for drawing from piecewise-constant densities.  cdf[n] is the sum of
+ the (non-negative) weights of cells 0...n-1, so cell n covers [cdf[n],cdf[n+1]).
+ Positions x are continuous, with cell n spanning [n,n+1).
+ */
+static void build_cumulative_table(double *weight, double *cdf, int N)
+{
+    cdf[0] = 0.0;
+    for(int n=0; n<N; n++) cdf[n+1] = cdf[n] + ((weight[n] > 0.0) ? weight[n] : 0.0);
+}
+
+static double cumulative_table_value(double *cdf, int N, double x)
+{
+    int n = (int)floor(x);
+    if(n<0)   return cdf[0];
+    if(n>=N)  return cdf[N];
+    return cdf[n] + (x-(double)n)*(cdf[n+1]-cdf[n]);
+}
+
+/* inverse-CDF draw of x in [xmin,xmax) with a binary search over the table */
+static double draw_from_cumulative_table(double *cdf, int N, double xmin, double xmax, gsl_rng *seed)
+{
+    double umin = cumulative_table_value(cdf, N, xmin);
+    double umax = cumulative_table_value(cdf, N, xmax);
+    
+    //no weight in range, fall back to uniform
+    if(!(umax > umin)) return xmin + gsl_rng_uniform(seed)*(xmax-xmin);
+    
+    double u = umin + gsl_rng_uniform(seed)*(umax-umin);
+    
+    int lo = (xmin > 0.0) ? (int)floor(xmin) : 0;
+    int hi = (xmax < (double)N) ? (int)ceil(xmax) : N;
+    while(hi-lo>1)
+    {
+        int mid = (lo+hi)/2;
+        if(cdf[mid] <= u) lo = mid;
+        else hi = mid;
+    }
+    
+    double x = (double)lo + (u-cdf[lo])/(cdf[lo+1]-cdf[lo]);
+    if(x<xmin) x = xmin;
+    if(x>xmax) x = xmax;
+    return x;
+}
+
+
 static void write_Fstat_animation(double fmin, double T, struct Proposal *proposal, char runDir[])
 {
     char filename[MAXSTRINGSIZE];
@@ -131,53 +178,42 @@ static void write_Fstat_animation(double fmin, double T, struct Proposal *propos
 void setup_frequency_proposal(struct Data *data, struct Flags *flags)
 {
     int BW = 20;
+    int N = data->N;
     double *power = data->p;
-    double total  = 0.0;
+    double *cdf   = data->pcdf;
     char filename[MAXSTRINGSIZE];
     sprintf(filename,"%s/data/frequency_proposal.dat",flags->runDir);
     FILE *temp = fopen(filename,"w");
-    for(int i=0; i<data->N-BW; i++)
-    {
-        power[i]=0.0;
-        for(int n=i; n<i+BW; n++)
-        {
-            double SnA = data->noise[FIXME]->SnA[n];
-            double SnE = data->noise[FIXME]->SnE[n];
-            
-            double AA = data->tdi[FIXME]->A[2*n]*data->tdi[FIXME]->A[2*n]+data->tdi[FIXME]->A[2*n+1]*data->tdi[FIXME]->A[2*n+1];
-            double EE = data->tdi[FIXME]->E[2*n]*data->tdi[FIXME]->E[2*n]+data->tdi[FIXME]->E[2*n+1]*data->tdi[FIXME]->E[2*n+1];
-            
-            power[i] += AA/SnA + EE/SnE;
-            total += power[i];
-        }
-    }
-    for(int i=data->N-BW; i<data->N; i++)
+    
+    //prefix sum of whitened power so each window is a single difference
+    cdf[0] = 0.0;
+    for(int n=0; n<N; n++)
     {
-        power[i] = power[data->N-BW-1];
-        total += power[i];
+        double SnA = data->noise[FIXME]->SnA[n];
+        double SnE = data->noise[FIXME]->SnE[n];
+        
+        double AA = data->tdi[FIXME]->A[2*n]*data->tdi[FIXME]->A[2*n]+data->tdi[FIXME]->A[2*n+1]*data->tdi[FIXME]->A[2*n+1];
+        double EE = data->tdi[FIXME]->E[2*n]*data->tdi[FIXME]->E[2*n]+data->tdi[FIXME]->E[2*n+1]*data->tdi[FIXME]->E[2*n+1];
+        
+        cdf[n+1] = cdf[n] + AA/SnA + EE/SnE;
     }
     
+    //also get SNR^2 of data
+    double total = cdf[N];
+    
+    for(int i=0; i<N-BW; i++) power[i] = cdf[i+BW] - cdf[i];
+    for(int i=N-BW; i<N; i++) power[i] = power[N-BW-1];
+    
     data->pmax = 0.0;
-    for(int i=0; i<data->N; i++)
+    for(int i=0; i<N; i++)
     {
         fprintf(temp,"%i %lg\n",i,power[i]);
         if(power[i]>data->pmax) data->pmax = power[i];
     }
     fclose(temp);
     
-    
-    //also get SNR^2 of data
-    total = 0.0;
-    for(int n=0; n<data->N; n++)
-    {
-        double SnA = data->noise[FIXME]->SnA[n];
-        double SnE = data->noise[FIXME]->SnE[n];
-        
-        double AA = data->tdi[FIXME]->A[2*n]*data->tdi[FIXME]->A[2*n]+data->tdi[FIXME]->A[2*n+1]*data->tdi[FIXME]->A[2*n+1];
-        double EE = data->tdi[FIXME]->E[2*n]*data->tdi[FIXME]->E[2*n]+data->tdi[FIXME]->E[2*n+1]*data->tdi[FIXME]->E[2*n+1];
-        
-        total += AA/SnA + EE/SnE;
-    }
+    //cumulative table of the windowed spectrum for draw_from_spectrum()
+    build_cumulative_table(power, cdf, N);
     
     data->SNR2 = total - data->N;
     printf("total=%g, N=%i\n",total, data->N);
@@ -202,23 +238,84 @@ void print_acceptance_rates(struct Proposal **proposal, int NP, int ic, FILE *fp
     }
 }
 
-double draw_from_spectrum(struct Data *data, struct Model *model, struct Source *source, UNUSED struct Proposal *proposal, double *params, gsl_rng *seed)
+/* smallest fraction of its hard-coded weight a proposal is tuned down to */
+#define TUNE_MIN_FRACTION 0.25
+
+void tune_proposal_weights(struct Proposal **proposal, struct Chain *chain, struct Flags *flags, int step)
 {
-    //TODO: Work in amplitude
+    int NP = chain->NP;
+    int NC = chain->NC;
+    double weight[NP];
+    double norm = 0.0;
     
-    //rejections ample for f
-    int check = 1;
-    double alpha;
-    int q;
-    int count=0;
-    while(check)
+    //accepted moves per second for each proposal, averaged over the temperature ladder
+    for(int n=0; n<NP; n++)
     {
-        params[0] = (double)model->prior[0][0] + gsl_rng_uniform(seed)*(double)(model->prior[0][1]-model->prior[0][0]);
-        alpha     = gsl_rng_uniform(seed)*data->pmax;
-        q = (int)(params[0]-data->qmin);
-        if(alpha<data->p[q]) check = 0;
-        count++;
+        weight[n] = 0.0;
+        if(!(proposal[n]->tune_weight > 0.0)) continue;
+        
+        int Nrate = 0;
+        double rate = 0.0;
+        for(int ic=0; ic<NC; ic++)
+        {
+            if(proposal[n]->tune_time[ic] > 0.0)
+            {
+                rate += (double)proposal[n]->tune_accept[ic]/proposal[n]->tune_time[ic];
+                Nrate++;
+            }
+        }
+        
+        //keep current weights until every proposal in use has been tried
+        if(Nrate==0) return;
+        
+        weight[n] = proposal[n]->tune_weight*rate/(double)Nrate;
+        norm += weight[n];
+    }
+    if(!(norm > 0.0)) return;
+    
+    //scale by efficiency, with a floor so no move is starved
+    double total = 0.0;
+    for(int n=0; n<NP; n++)
+    {
+        weight[n] /= norm;
+        if(weight[n] < TUNE_MIN_FRACTION*proposal[n]->tune_weight) weight[n] = TUNE_MIN_FRACTION*proposal[n]->tune_weight;
+        total += weight[n];
+    }
+    for(int n=0; n<NP; n++) proposal[n]->weight = weight[n]/total;
+    
+    //dump measurements for inspection
+    char filename[MAXSTRINGSIZE];
+    sprintf(filename,"%s/data/proposal_tuning.dat",flags->runDir);
+    FILE *fptr = fopen(filename,"w");
+    fprintf(fptr,"#step=%i\n",step);
+    fprintf(fptr,"#proposal chain temperature trials accepts seconds accepts/second weight\n");
+    for(int n=0; n<NP; n++)
+    {
+        if(!(proposal[n]->tune_weight > 0.0)) continue;
+        for(int ic=0; ic<NC; ic++)
+        {
+            double time = proposal[n]->tune_time[ic];
+            fprintf(fptr,"%s %i %lg %i %i %lg %lg %lg\n", proposal[n]->name, ic, chain->temperature[ic], proposal[n]->tune_trial[ic], proposal[n]->tune_accept[ic], time, (time > 0.0) ? (double)proposal[n]->tune_accept[ic]/time : 0.0, proposal[n]->weight);
+        }
     }
+    fclose(fptr);
+    
+    sprintf(filename,"%s/data/proposal_weights.dat",flags->runDir);
+    fptr = fopen(filename,"a");
+    fprintf(fptr,"%i",step);
+    for(int n=0; n<NP; n++) fprintf(fptr," %lg",proposal[n]->weight);
+    fprintf(fptr,"\n");
+    fclose(fptr);
+}
+
+double draw_from_spectrum(struct Data *data, struct Model *model, struct Source *source, UNUSED struct Proposal *proposal, double *params, gsl_rng *seed)
+{
+    //TODO: Work in amplitude
+    
+    //inverse-CDF draw for f over the prior range
+    double qmin = (double)model->prior[0][0] - data->qmin;
+    double qmax = (double)model->prior[0][1] - data->qmin;
+    params[0] = data->qmin + draw_from_cumulative_table(data->pcdf, data->N, qmin, qmax, seed);
 
     //random draws for other parameters
     for(int n=1; n<source->NP; n++) params[n] = model->prior[n][0] + gsl_rng_uniform(seed)*(model->prior[n][1]-model->prior[n][0]);
@@ -233,27 +330,23 @@ double draw_from_prior(struct Data *data, struct Model *model, struct Source *so
 
 double draw_from_gmm_prior(struct Data *data, struct Model *model, struct Source *source, struct Proposal *proposal, double *params, gsl_rng *seed)
 {
+    struct CatalogGMM *gmm = data->catalog->gmm;
     int NP = source->NP;
     double ran_no[NP];
     
     //choose which entry
-    int ngmm = (int)floor(gsl_rng_uniform(seed)*proposal->Ngmm);
-    int NMODES = proposal->gmm[ngmm]->NMODE;
-    
-    struct MVG **modes = proposal->gmm[ngmm]->modes;
-    struct MVG *mode = NULL;
+    int entry = (int)floor(gsl_rng_uniform(seed)*gmm->Nentry);
     
     //pick which mode
-    int k;
-    double p = 1.;
-    do {
-        k = (int)floor(gsl_rng_uniform(seed)*NMODES);
-        mode = modes[k];
-        p = gsl_rng_uniform(seed);
-    } while (p>mode->p);
+    int k = gmm->first[entry];
+    double u = gsl_rng_uniform(seed);
+    while(k < gmm->first[entry+1]-1 && gmm->cdf[k] <= u) k++;
     
+    double *mu     = gmm->mu + k*NP;
+    double *L      = gmm->L + k*NP*NP;
+    double *minmax = gmm->minmax + entry*NP*2;
 
-    //get vector of gaussian draws n;  y_i = x_mean_i + sum_j Lij^-1 * n_j
+    //get vector of gaussian draws n;  y_i = x_mean_i + sum_j Lij * n_j
     for(int n=0; n<NP; n++)
     {
         ran_no[n] = gsl_ran_gaussian(seed,1.0);
@@ -264,16 +357,13 @@ double draw_from_gmm_prior(struct Data *data, struct Model *model, struct Source
     for(int n=0; n<NP; n++)
     {
         //start at mean
-        x[n] = gsl_vector_get(mode->mu,n);
+        x[n] = mu[n];
         
-        //add contribution from each row of invC
-        for(int m=0; m<NP; m++) x[n] += ran_no[m]*gsl_matrix_get(mode->L,n,m);
+        //add contribution from each row of L
+        for(int m=0; m<=n; m++) x[n] += ran_no[m]*L[n*NP+m];
         
         //map params from R back to interval
-        double min = gsl_matrix_get(mode->minmax,n,0);
-        double max = gsl_matrix_get(mode->minmax,n,1);
-        
-        x[n] = sigmoid(x[n],min,max);
+        x[n] = sigmoid(x[n],minmax[2*n],minmax[2*n+1]);
     }
     
     //map to parameters
@@ -291,17 +381,10 @@ double draw_from_gmm_prior(struct Data *data, struct Model *model, struct Source
     return gmm_prior_density(data, model, source, proposal, params);
 }
 
-double gmm_prior_density(struct Data *data, struct Model *model, struct Source *source, struct Proposal *proposal, double *params)
+double gmm_prior_density(struct Data *data, UNUSED struct Model *model, UNUSED struct Source *source, UNUSED struct Proposal *proposal, double *params)
 {
-    double p = 0;
-    
-    /* sum over modes */
-    for(int n=0; n<proposal->Ngmm; n++)
-    {
-        p += exp(evaluate_gmm_prior(data, proposal->gmm[n], params));
-    }
-        
-    return log(p/(double)proposal->Ngmm);
+    /* average over catalog entries */
+    return catalog_gmm_density(data->catalog->gmm, params, data->T);
 }
 
 double draw_from_uniform_prior(UNUSED struct Data *data, struct Model *model, UNUSED struct Source *source, UNUSED struct Proposal *proposal, double *params, gsl_rng *seed)
@@ -797,6 +880,11 @@ void initialize_proposal(struct Orbit *orbit, struct Data *data, struct Prior *p
         proposal[i]->trial  = malloc(NC*sizeof(int));
         proposal[i]->accept = malloc(NC*sizeof(int));
         
+        proposal[i]->tune_trial  = calloc(NC,sizeof(int));
+        proposal[i]->tune_accept = calloc(NC,sizeof(int));
+        proposal[i]->tune_time   = calloc(NC,sizeof(double));
+        proposal[i]->local = 0;
+        
         for(int ic=0; ic<NC; ic++)
         {
             proposal[i]->trial[ic]  = 1;
@@ -855,6 +943,7 @@ void initialize_proposal(struct Orbit *orbit, struct Data *data, struct Prior *p
                 sprintf(proposal[i]->name,"fisher");
                 proposal[i]->function = &draw_from_fisher;
                 proposal[i]->density  = &symmetric_density;
+                proposal[i]->local    = 1;
                 proposal[i]->weight = 1.0; //that's a 1 all right.  don't panic
                 proposal[i]->rjweight = 0.0;
                 //check   += proposal[i]->weight;
@@ -924,6 +1013,20 @@ void initialize_proposal(struct Orbit *orbit, struct Data *data, struct Prior *p
         exit(1);
     }
     
+    //starting point for tune_proposal_weights()
+    for(int i=0; i<chain->NP; i++) proposal[i]->tune_weight = proposal[i]->weight;
+    
+    if(flags->tuneProposals)
+    {
+        char filename[MAXSTRINGSIZE];
+        sprintf(filename,"%s/data/proposal_weights.dat",flags->runDir);
+        FILE *fptr = fopen(filename, flags->resume ? "a" : "w");
+        fprintf(fptr,"#step");
+        for(int i=0; i<chain->NP; i++) fprintf(fptr," [%s]",proposal[i]->name);
+        fprintf(fptr,"\n");
+        fclose(fptr);
+    }
+    
     if(!flags->quiet)
     {
         fprintf(stdout,"\n============== Proposal Cocktail ==============\n");
@@ -943,6 +1046,280 @@ void initialize_proposal(struct Orbit *orbit, struct Data *data, struct Prior *p
 
 
 
+/* FNV-1a hash of a block of memory, continuing from hash */
+static unsigned long hash_bytes(unsigned long hash, const void *ptr, size_t size)
+{
+    const unsigned char *byte = ptr;
+    for(size_t n=0; n<size; n++)
+    {
+        hash ^= (unsigned long)byte[n];
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+/* Fingerprint of everything the F-statistic grid depends on besides its resolution */
+static unsigned long fstatistic_data_hash(struct Orbit *orbit, struct Data *data)
+{
+    unsigned long hash = 14695981039346656037UL;
+    
+    hash = hash_bytes(hash, data->tdi[FIXME]->X, 2*data->N*sizeof(double));
+    hash = hash_bytes(hash, data->tdi[FIXME]->A, 2*data->N*sizeof(double));
+    hash = hash_bytes(hash, data->tdi[FIXME]->E, 2*data->N*sizeof(double));
+    hash = hash_bytes(hash, data->noise[FIXME]->SnX, data->N*sizeof(double));
+    hash = hash_bytes(hash, data->noise[FIXME]->SnA, data->N*sizeof(double));
+    hash = hash_bytes(hash, data->noise[FIXME]->SnE, data->N*sizeof(double));
+    hash = hash_bytes(hash, &orbit->L, sizeof(double));
+    hash = hash_bytes(hash, &orbit->fstar, sizeof(double));
+    hash = hash_bytes(hash, data->format, strlen(data->format));
+    
+    //orbit model: analytic, or the tabulated ephemerides from --orbit
+    int numeric = (orbit->orbit_function != &analytic_orbits);
+    hash = hash_bytes(hash, &numeric, sizeof(int));
+    if(numeric)
+    {
+        hash = hash_bytes(hash, &orbit->Norb, sizeof(int));
+        hash = hash_bytes(hash, orbit->t, orbit->Norb*sizeof(double));
+        for(int i=0; i<3; i++)
+        {
+            hash = hash_bytes(hash, orbit->x[i], orbit->Norb*sizeof(double));
+            hash = hash_bytes(hash, orbit->y[i], orbit->Norb*sizeof(double));
+            hash = hash_bytes(hash, orbit->z[i], orbit->Norb*sizeof(double));
+        }
+    }
+    
+    return hash;
+}
+
+/*
+ Binary F-statistic proposal cache:
+ header {hash, qmin, N, qpad, n_f, n_theta, n_phi, adaptive, T, t0} followed by
+ {norm, maxp} and the normalized n_f x n_theta x n_phi tensor.
+ */
+struct FstatCacheHeader
+{
+    unsigned long hash;
+    int qmin;
+    int N;
+    int qpad;
+    int n_f;
+    int n_theta;
+    int n_phi;
+    int adaptive;
+    double T;
+    double t0;
+};
+
+static void fstatistic_cache_header(struct Data *data, struct Flags *flags, unsigned long hash, struct Proposal *proposal, struct FstatCacheHeader *header)
+{
+    memset(header, 0, sizeof(struct FstatCacheHeader));
+    header->hash    = hash;
+    header->qmin    = data->qmin;
+    header->N       = data->N;
+    header->qpad    = data->qpad;
+    header->n_f     = (int)proposal->matrix[0][0];
+    header->n_theta = (int)proposal->matrix[1][0];
+    header->n_phi   = (int)proposal->matrix[2][0];
+    header->adaptive= flags->fstatAdaptive;
+    header->T       = data->T;
+    header->t0      = data->t0[FIXME];
+}
+
+static int read_fstatistic_cache(char *filename, struct Data *data, struct Flags *flags, unsigned long hash, struct Proposal *proposal)
+{
+    FILE *fptr = fopen(filename,"rb");
+    if(fptr==NULL) return 0;
+    
+    struct FstatCacheHeader expected, header;
+    fstatistic_cache_header(data, flags, hash, proposal, &expected);
+    
+    int status = 0;
+    if(fread(&header, sizeof(struct FstatCacheHeader), 1, fptr) == 1 && memcmp(&header, &expected, sizeof(struct FstatCacheHeader)) == 0)
+    {
+        double norm, maxp;
+        status = (fread(&norm, sizeof(double), 1, fptr) == 1) && (fread(&maxp, sizeof(double), 1, fptr) == 1);
+        for(int i=0; i<header.n_f && status; i++)
+            for(int j=0; j<header.n_theta && status; j++)
+                status = (fread(proposal->tensor[i][j], sizeof(double), header.n_phi, fptr) == (size_t)header.n_phi);
+        
+        if(status)
+        {
+            proposal->norm = norm;
+            proposal->maxp = maxp;
+        }
+    }
+    fclose(fptr);
+    
+    return status;
+}
+
+static void write_fstatistic_cache(char *filename, struct Data *data, struct Flags *flags, unsigned long hash, struct Proposal *proposal)
+{
+    FILE *fptr = fopen(filename,"wb");
+    if(fptr==NULL)
+    {
+        fprintf(stderr,"Warning: Could not write F-statistic cache %s\n",filename);
+        return;
+    }
+    
+    struct FstatCacheHeader header;
+    fstatistic_cache_header(data, flags, hash, proposal, &header);
+    
+    fwrite(&header, sizeof(struct FstatCacheHeader), 1, fptr);
+    fwrite(&proposal->norm, sizeof(double), 1, fptr);
+    fwrite(&proposal->maxp, sizeof(double), 1, fptr);
+    for(int i=0; i<header.n_f; i++)
+        for(int j=0; j<header.n_theta; j++)
+            fwrite(proposal->tensor[i][j], sizeof(double), header.n_phi, fptr);
+    
+    fclose(fptr);
+}
+
+/*
+ Coarse-to-fine F-statistic sky grid.
+ The sky is tiled into FSTAT_BLOCK x FSTAT_BLOCK blocks of grid cells, and the
+ F-statistic is first evaluated once per block, at its central cell.  Blocks
+ whose value, or that of an adjacent block in sky or frequency, exceeds
+ max(FSTAT_REFINE_FRACTION*max(logL), FSTAT_REFINE_LOGL) are then evaluated
+ cell by cell.  All other cells take the value of their block, so the proposal
+ keeps the layout used by draw_from_fstatistic() and evaluate_fstatistic_proposal().
+ */
+#define FSTAT_BLOCK 3
+#define FSTAT_REFINE_FRACTION 0.1
+#define FSTAT_REFINE_LOGL 10.0
+
+static void adaptive_fstatistic_grid(struct Orbit *orbit, struct Data *data, struct Flags *flags, struct Proposal *proposal, double *norm_out, double *maxLogL_out)
+{
+    int n_f     = (int)proposal->matrix[0][0];
+    int n_theta = (int)proposal->matrix[1][0];
+    int n_phi   = (int)proposal->matrix[2][0];
+    
+    double d_f     = proposal->matrix[0][1];
+    double d_theta = proposal->matrix[1][1];
+    double d_phi   = proposal->matrix[2][1];
+    
+    int n_tb = (n_theta + FSTAT_BLOCK - 1)/FSTAT_BLOCK;
+    int n_pb = (n_phi   + FSTAT_BLOCK - 1)/FSTAT_BLOCK;
+    
+    double fdot = 0.0;
+    
+    double ***coarse = malloc(n_f*sizeof(double **));
+    for(int i=0; i<n_f; i++)
+    {
+        coarse[i] = malloc(n_tb*sizeof(double *));
+        for(int bj=0; bj<n_tb; bj++) coarse[i][bj] = calloc(n_pb,sizeof(double));
+    }
+    
+    double norm = 0.0;
+    double maxLogL = -1e60;
+    
+    //coarse pass: one evaluation per block
+    #pragma omp parallel for num_threads(flags->threads) schedule(dynamic) reduction(max:maxLogL)
+    for(int i=1; i<n_f-1; i++)
+    {
+        double Fmax[4];
+        double logL_X,logL_AE;
+        double f = ((double)(data->qmin) + (double)(i)*d_f)/data->T;
+        
+        for(int bj=0; bj<n_tb; bj++)
+        {
+            int j = bj*FSTAT_BLOCK + FSTAT_BLOCK/2;
+            if(j>=n_theta) j = n_theta-1;
+            double theta = acos((-1. + (double)j*d_theta));
+            
+            for(int bk=0; bk<n_pb; bk++)
+            {
+                int k = bk*FSTAT_BLOCK + FSTAT_BLOCK/2;
+                if(k>=n_phi) k = n_phi-1;
+                double phi = (double)k*d_phi;
+                
+                get_Fstat_logL(orbit, data, f, fdot, theta, phi, &logL_X, &logL_AE, Fmax);
+                coarse[i][bj][bk] = logL_AE;
+                if(logL_AE > maxLogL) maxLogL = logL_AE;
+            }
+        }
+    }
+    
+    double threshold = FSTAT_REFINE_FRACTION*maxLogL;
+    if(threshold < FSTAT_REFINE_LOGL) threshold = FSTAT_REFINE_LOGL;
+    
+    //fine pass: refine loud blocks and their neighbors
+    int refined = 0;
+    #pragma omp parallel for num_threads(flags->threads) schedule(dynamic) reduction(+:norm,refined) reduction(max:maxLogL)
+    for(int i=0; i<n_f; i++)
+    {
+        double Fmax[4];
+        double logL_X,logL_AE;
+        double f = ((double)(data->qmin) + (double)(i)*d_f)/data->T;
+        
+        for(int bj=0; bj<n_tb; bj++)
+        {
+            for(int bk=0; bk<n_pb; bk++)
+            {
+                //first and last frequency sub-bins are left flat, as on the uniform grid
+                int refine = 0;
+                if(i>0 && i<n_f-1)
+                {
+                    for(int di=-1; di<=1 && !refine; di++)
+                    {
+                        int ii = i+di;
+                        if(ii<1 || ii>n_f-2) continue;
+                        for(int dj=-1; dj<=1 && !refine; dj++)
+                        {
+                            int jj = bj+dj;
+                            if(jj<0 || jj>=n_tb) continue;
+                            for(int dk=-1; dk<=1 && !refine; dk++)
+                            {
+                                int kk = (bk+dk+n_pb)%n_pb; //longitude is periodic
+                                if(coarse[ii][jj][kk] >= threshold) refine = 1;
+                            }
+                        }
+                    }
+                }
+                
+                for(int j=bj*FSTAT_BLOCK; j<(bj+1)*FSTAT_BLOCK && j<n_theta; j++)
+                {
+                    double theta = acos((-1. + (double)j*d_theta));
+                    
+                    for(int k=bk*FSTAT_BLOCK; k<(bk+1)*FSTAT_BLOCK && k<n_phi; k++)
+                    {
+                        double phi = (double)k*d_phi;
+                        
+                        if(refine)
+                        {
+                            get_Fstat_logL(orbit, data, f, fdot, theta, phi, &logL_X, &logL_AE, Fmax);
+                            if(logL_AE > maxLogL) maxLogL = logL_AE;
+                            proposal->tensor[i][j][k] = logL_AE;
+                        }
+                        else if(i>0 && i<n_f-1)
+                        {
+                            proposal->tensor[i][j][k] = coarse[i][bj][bk];
+                        }
+                        
+                        norm += proposal->tensor[i][j][k];
+                    }
+                }
+                refined += refine;
+            }
+        }
+    }
+    
+    if(!flags->quiet)
+    {
+        fprintf(stdout,"   refined %i of %i sky blocks (threshold logL = %g)\n",refined,(n_f-2)*n_tb*n_pb,threshold);
+    }
+    
+    for(int i=0; i<n_f; i++)
+    {
+        for(int bj=0; bj<n_tb; bj++) free(coarse[i][bj]);
+        free(coarse[i]);
+    }
+    free(coarse);
+    
+    *norm_out    = norm;
+    *maxLogL_out = maxLogL;
+}
+
 void setup_fstatistic_proposal(struct Orbit *orbit, struct Data *data, struct Flags *flags, struct Proposal *proposal)
 {
     /*
@@ -954,9 +1331,6 @@ void setup_fstatistic_proposal(struct Orbit *orbit, struct Data *data, struct Fl
      - normalize to make it a proper proposal (this part is a pain to get right...)
      */
     
-    //matrix to hold maximized extrinsic parameters
-    double *Fparams = calloc(4,sizeof(double));
-    
     //grid sizes
     int n_f     = 4*data->N;
     int n_theta = 30;
@@ -983,9 +1357,6 @@ void setup_fstatistic_proposal(struct Orbit *orbit, struct Data *data, struct Fl
     
     double fdot = 0.0; //TODO: what to do about fdot...
     
-    //F-statistic for TDI variabls
-    double logL_X,logL_AE;
-    
     //allocate memory in proposal structure and pack up metadata
     /*
      proposal->matrix is 3x2 matrix.
@@ -1023,49 +1394,101 @@ void setup_fstatistic_proposal(struct Orbit *orbit, struct Data *data, struct Fl
         }
     }
     
-    double norm = 0.0;
-    double maxLogL = -1e60;
+    /* reuse tensor from an earlier run on the same data and grid */
+    char cacheFile[MAXSTRINGSIZE];
+    sprintf(cacheFile,"%s/checkpoint/fstat_proposal.bin",flags->runDir);
+    unsigned long hash = fstatistic_data_hash(orbit, data);
     
-    //loop over sub-bins
-    for(int i=0; i<n_f; i++)
+    if(read_fstatistic_cache(cacheFile, data, flags, hash, proposal))
     {
-        if(i%(n_f/100)==0 && !flags->quiet)printProgress((double)i/(double)n_f);
-        
-        double q = (double)(data->qmin) + (double)(i)*d_f;
-        double f = q/data->T;
-        
+        if(!flags->quiet) fprintf(stdout,"   loaded from %s\n",cacheFile);
+    }
+    else
+    {
+        double norm = 0.0;
+        double maxLogL = -1e60;
         
-        //loop over colatitude bins
-        for (int j=0; j<n_theta; j++)
+        if(flags->fstatAdaptive)
         {
-            double theta = acos((-1. + (double)j*d_theta));
+            adaptive_fstatistic_grid(orbit, data, flags, proposal, &norm, &maxLogL);
+        }
+        else
+        {
+            int progress = 0;
             
-            //loop over longitude bins
-            for(int k=0; k<n_phi; k++)
+            //loop over sub-bins
+            #pragma omp parallel for num_threads(flags->threads) schedule(dynamic) reduction(+:norm) reduction(max:maxLogL)
+            for(int i=0; i<n_f; i++)
             {
-                double phi = (double)k*d_phi;
+                //extrinsic parameters are per-thread scratch
+                double Fmax[4];
+                double logL_X,logL_AE;
                 
-                if(i>0 && i<n_f-1)
+                if(omp_get_thread_num()==0 && !flags->quiet)printProgress((double)progress/(double)n_f);
+                
+                double q = (double)(data->qmin) + (double)(i)*d_f;
+                double f = q/data->T;
+                
+                
+                //loop over colatitude bins
+                for (int j=0; j<n_theta; j++)
                 {
-                    get_Fstat_logL(orbit, data, f, fdot, theta, phi, &logL_X, &logL_AE, Fparams);
+                    double theta = acos((-1. + (double)j*d_theta));
                     
-                    if(logL_AE > maxLogL) maxLogL = logL_AE;
-                    //if(logL_AE > SNRCAP)  logL_AE = SNRCAP;//TODO: Test SNRCAP in fstatistic
-                    
-                    proposal->tensor[i][j][k] = logL_AE;//sqrt(2*logL_AE);
-                }
+                    //loop over longitude bins
+                    for(int k=0; k<n_phi; k++)
+                    {
+                        double phi = (double)k*d_phi;
+                        
+                        if(i>0 && i<n_f-1)
+                        {
+                            get_Fstat_logL(orbit, data, f, fdot, theta, phi, &logL_X, &logL_AE, Fmax);
+                            
+                            if(logL_AE > maxLogL) maxLogL = logL_AE;
+                            //if(logL_AE > SNRCAP)  logL_AE = SNRCAP;//TODO: Test SNRCAP in fstatistic
+                            
+                            proposal->tensor[i][j][k] = logL_AE;//sqrt(2*logL_AE);
+                        }
+                        
+                        norm += proposal->tensor[i][j][k];
+                        
+                    }//end loop over longitude bins
+                }//end loop over colatitude bins
                 
-                norm += proposal->tensor[i][j][k];
-                
-            }//end loop over longitude bins
-        }//end loop over colatitude bins
-    }//end loop over sub-bins
-    
-    //normalize
-    proposal->norm = (n_f*n_theta*n_phi)/norm;
-    proposal->maxp = maxLogL*proposal->norm;//sqrt(2.*maxLogL)*proposal->norm;
+                #pragma omp atomic
+                progress++;
+            }//end loop over sub-bins
+        }
+        
+        //normalize
+        proposal->norm = (n_f*n_theta*n_phi)/norm;
+        proposal->maxp = maxLogL*proposal->norm;//sqrt(2.*maxLogL)*proposal->norm;
+        
+        for(int i=0; i<n_f; i++) for(int j=0; j<n_theta; j++) for(int k=0; k<n_phi; k++) proposal->tensor[i][j][k] *= proposal->norm;
+        
+        write_fstatistic_cache(cacheFile, data, flags, hash, proposal);
+    }
     
-    for(int i=0; i<n_f; i++) for(int j=0; j<n_theta; j++) for(int k=0; k<n_phi; k++) proposal->tensor[i][j][k] *= proposal->norm;
+    /*
+     proposal->vector is the cumulative table of the tensor,
+     flattened as (i*n_theta + j)*n_phi + k, used by draw_from_fstatistic()
+     */
+    proposal->size   = n_f*n_theta*n_phi;
+    proposal->vector = malloc((proposal->size+1)*sizeof(double));
+    proposal->vector[0] = 0.0;
+    int cell = 0;
+    for(int i=0; i<n_f; i++)
+    {
+        for(int j=0; j<n_theta; j++)
+        {
+            for(int k=0; k<n_phi; k++)
+            {
+                double p = proposal->tensor[i][j][k];
+                proposal->vector[cell+1] = proposal->vector[cell] + ((p > 0.0) ? p : 0.0);
+                cell++;
+            }
+        }
+    }
     
     if(flags->verbose)
     {
@@ -1095,7 +1518,6 @@ void setup_fstatistic_proposal(struct Orbit *orbit, struct Data *data, struct Fl
         write_Fstat_animation(data->qmin/data->T, data->T,proposal,flags->runDir);
     }
     
-    free(Fparams);
     if(!flags->quiet)fprintf(stdout,"\n==============================================\n\n");
     fflush(stdout);
 }
@@ -1129,7 +1551,7 @@ void setup_prior_proposal(struct Flags *flags, struct Prior *prior, struct Propo
 }
 
 
-void setup_cdf_proposal(struct Data *data, struct Flags *flags, struct Proposal *proposal, int NMAX)
+void setup_cdf_proposal(struct Data *data, struct Flags *flags, struct Proposal *proposal, UNUSED int NMAX)
 {
     if(!flags->quiet)fprintf(stdout,"\n============== Chain CDF proposal ==============\n\n");
     
@@ -1138,63 +1560,15 @@ void setup_cdf_proposal(struct Data *data, struct Flags *flags, struct Proposal
      8x1D proposals from the marginalized posteriors
      */
     
-    double junk;
-    FILE *fptr=NULL;
-    
     //parse chain file
     if(!flags->quiet)fprintf(stdout,"  reading chain file %s...\n",flags->cdfFile);
-    fptr = fopen(flags->cdfFile,"r");
-    proposal->size=0;
-    while(!feof(fptr))
-    {
-        for(int j=0; j<data->NP; j++)
-        {
-            int check = fscanf(fptr,"%lg",&junk);
-            if(!check)
-            {
-                fprintf(stderr,"Error reading %s\n",flags->cdfFile);
-                exit(1);
-            }
-        }
-        proposal->size++;
-    }
-    rewind(fptr);
-    proposal->size--;
-    
-    if(!flags->quiet)fprintf(stdout, "  samples in chain: %i\n",proposal->size);
-    
-    proposal->vector = calloc(proposal->size , sizeof(double));
     proposal->matrix = malloc(data->NP * sizeof(double*));
-    for(int j=0; j<data->NP; j++) proposal->matrix[j] = calloc(proposal->size , sizeof(double));
-    
-    struct Model *temp = malloc(sizeof(struct Model));
-    alloc_model(temp,NMAX,data->N,data->Nchannel, data->NP, data->NT);
+    proposal->size = read_chain_file(data, flags->cdfFile, proposal->matrix);
     
-    for(int n=0; n<proposal->size; n++)
-    {
-        scan_source_params(data, temp->source[0], fptr);
-        for(int j=0; j<data->NP; j++) proposal->matrix[j][n] = temp->source[0]->params[j];
-    }
-    free_model(temp);
+    if(!flags->quiet)fprintf(stdout, "  samples in chain: %i\n",proposal->size);
     
     //now sort each row of the matrix
-    for(int j=0; j<data->NP; j++)
-    {
-        //fill up proposal vector
-        for(int n=0; n<proposal->size; n++)
-            proposal->vector[n] = proposal->matrix[j][n];
-        
-        //sort it
-        gsl_sort(proposal->vector,1, proposal->size);
-        
-        //replace that row of the matrix
-        for(int n=0; n<proposal->size; n++)
-            proposal->matrix[j][n] = proposal->vector[n];
-    }
-    
-    free(proposal->vector);
-    
-    fclose(fptr);
+    for(int j=0; j<data->NP; j++) gsl_sort(proposal->matrix[j],1, proposal->size);
     
     if(!flags->quiet)fprintf(stdout,"\n================================================\n");
 }
@@ -1397,47 +1771,43 @@ void setup_covariance_proposal(struct Data *data, struct Flags *flags, struct Pr
     if(!flags->quiet)fprintf(stdout,"\n================================================\n");
 }
 
-double draw_from_fstatistic(struct Data *data, UNUSED struct Model *model, UNUSED struct Source *source, struct Proposal *proposal, double *params, gsl_rng *seed)
+/*
+ Draw a point on the F-statistic grid between flattened cells [cmin,cmax),
+ returned as continuous grid coordinates {i,j,k} uniform within the cell
+ */
+static void draw_fstatistic_cell(struct Proposal *proposal, int cmin, int cmax, double *i, double *j, double *k, gsl_rng *seed)
 {
-    double logP = 0.0;
-    
-    int n_f     = (int)proposal->matrix[0][0];
     int n_theta = (int)proposal->matrix[1][0];
     int n_phi   = (int)proposal->matrix[2][0];
     
+    double x = draw_from_cumulative_table(proposal->vector, proposal->size, (double)cmin, (double)cmax, seed);
+    int cell = (int)floor(x);
+    if(cell>cmax-1) cell = cmax-1;
+    
+    *i = (double)(cell/(n_theta*n_phi)) + gsl_rng_uniform(seed);
+    *j = (double)((cell/n_phi)%n_theta) + gsl_rng_uniform(seed);
+    *k = (double)(cell%n_phi) + (x - (double)cell);
+}
+
+double draw_from_fstatistic(struct Data *data, UNUSED struct Model *model, UNUSED struct Source *source, struct Proposal *proposal, double *params, gsl_rng *seed)
+{
+    double logP = 0.0;
+    
     double d_f     = proposal->matrix[0][1];
     double d_theta = proposal->matrix[1][1];
     double d_phi   = proposal->matrix[2][1];
     
-    double q,costheta,phi,p,alpha;
-    
     double i,j,k;
     
     //first draw from prior
     draw_from_uniform_prior(data, model, source, proposal, params, seed);
     
-    //now rejection sample on f,theta,phi
-    int check=1;
-    while(check)
-    {
-        i = gsl_rng_uniform(seed)*n_f;
-        j = gsl_rng_uniform(seed)*n_theta;
-        k = gsl_rng_uniform(seed)*n_phi;
-        
-        q        = (double)(data->qmin) + i*d_f;
-        costheta = -1. + j*d_theta;
-        phi      = k*d_phi;
-                
-        p = proposal->tensor[(int)i][(int)j][(int)k];
-        alpha = gsl_rng_uniform(seed)*proposal->maxp;
-        
-        if(p>alpha)check=0;
-        
-    }
+    //now draw f,theta,phi from the cumulative table
+    draw_fstatistic_cell(proposal, 0, proposal->size, &i, &j, &k, seed);
     
-    params[0] = q;
-    params[1] = costheta;
-    params[2] = phi;
+    params[0] = (double)(data->qmin) + i*d_f;
+    params[1] = -1. + j*d_theta;
+    params[2] = k*d_phi;
     
     logP = evaluate_fstatistic_proposal(data, model, source, proposal, params);
     
@@ -1456,10 +1826,12 @@ double jump_from_fstatistic(struct Data *data, struct Model *model, struct Sourc
     double d_theta = proposal->matrix[1][1];
     double d_phi   = proposal->matrix[2][1];
     
-    double q,costheta,phi,p,alpha;
-    
     double i=0,j,k;
     
+    //range of flattened cells to draw from
+    int cmin = 0;
+    int cmax = proposal->size;
+    
     /* half the time do an fm shift, half the time completely reboot frequency */
     int fmFlag = 0;
     if(gsl_rng_uniform(seed)<-0.5) fmFlag=1;
@@ -1468,45 +1840,23 @@ double jump_from_fstatistic(struct Data *data, struct Model *model, struct Sourc
     {
         fm_shift(data, model, source, proposal, params, seed);
         
-        q = params[0];
-        i = floor((q-data->qmin)/d_f);
+        i = floor((params[0]-data->qmin)/d_f);
         
         if(i<0.0 || i>n_f-1) return -INFINITY;
-    }
-    
-    //now rejection sample on f,theta,phi
-    int check=1;
-    while(check)
-    {
-        if(!fmFlag)i = gsl_rng_uniform(seed)*n_f;
-        j = gsl_rng_uniform(seed)*n_theta;
-        k = gsl_rng_uniform(seed)*n_phi;
-        
-        q        = (double)(data->qmin) + i*d_f;
-        costheta = -1. + j*d_theta;
-        phi      = k*d_phi;
-        
-        if(
-           ((int)i < 0 || (int)i > n_f-1)     ||
-           ((int)j < 0 || (int)j > n_theta-1) ||
-           ((int)k < 0 || (int)k > n_phi-1)
-           )
-        {
-            fprintf(stdout,"%i (%i) %i (%i) %i (%i)\n",(int)i,n_f,(int)j,n_theta,(int)k,n_phi);
-            fflush(stdout);
-            return -INFINITY;
-        }
-        else
-            p = proposal->tensor[(int)i][(int)j][(int)k];
-        alpha = gsl_rng_uniform(seed)*proposal->maxp;
-        
-        if(p>alpha)check=0;
         
+        //only draw sky location in the shifted frequency bin
+        cmin = (int)i*n_theta*n_phi;
+        cmax = cmin + n_theta*n_phi;
     }
     
-    params[0] = q;
-    params[1] = costheta;
-    params[2] = phi;
+    //now draw f,theta,phi from the cumulative table
+    double i_cell;
+    draw_fstatistic_cell(proposal, cmin, cmax, &i_cell, &j, &k, seed);
+    if(!fmFlag) i = i_cell;
+    
+    params[0] = (double)(data->qmin) + i*d_f;
+    params[1] = -1. + j*d_theta;
+    params[2] = k*d_phi;
     
     logP = evaluate_fstatistic_proposal(data, model, source, proposal, params);
     
@@ -69,6 +69,7 @@ struct Proposal
     double maxp;     //!<max value of proposal density for rejection sampling
     double weight;   //!<proposal weight [0,1] for fixed dimension moves
     double rjweight; //!<proposal weight [0,1] for trans dimensional moves
+    int local;       //!<proposal only makes small jumps from the current state, screened by Flags::delayedAccept
     int size;        //!<size of proposal arrays
     double *vector;  //!<utility 1D array for proposal metadata
     double **matrix; //!<utility 2D array for proposal metadata
@@ -80,10 +81,23 @@ struct Proposal
     size_t Ngmm; //!< number of mixture models (1/source)
     struct GMM **gmm; //!<array of individual mixture models
     ///@}
+    
+    /** @name Weight tuning
+     Fixed dimension statistics used by tune_proposal_weights()
+     */
+    ///@{
+    double tune_weight; //!<hard-coded weight set by initialize_proposal()
+    int *tune_trial;    //!<fixed dimension trials during burn in, per chain
+    int *tune_accept;   //!<fixed dimension acceptances during burn in, per chain
+    double *tune_time;  //!<wall-clock seconds spent on fixed dimension trials during burn in, per chain
+    ///@}
 };
 
 /**
  \brief Compute whitened power spectrum of data and normalize to preferentially draw frequencies with excess power
+ 
+ Power is summed over a sliding window using a prefix sum, and its cumulative
+ distribution is stored in Data::pcdf for inverse-CDF draws in draw_from_spectrum().
  */
 void setup_frequency_proposal(struct Data *data, struct Flags *flags);
 
@@ -92,6 +106,22 @@ void setup_frequency_proposal(struct Data *data, struct Flags *flags);
  */
 void print_acceptance_rates(struct Proposal **proposal, int NP, int ic, FILE *fptr);
 
+/**
+ \brief Reweight fixed dimension proposals by accepted moves per second
+ 
+ For each proposal with a non-zero Proposal::tune_weight the accepted moves per
+ wall-clock second is measured from Proposal::tune_accept and Proposal::tune_time
+ for each chain and averaged over the temperature ladder.
+ The new Proposal::weight is proportional to the hard-coded weight times that rate,
+ floored at a quarter of the hard-coded weight so that no move is starved, and
+ normalized to sum to one.
+ 
+ Only call during burn in. The weights are frozen afterwards to preserve detailed balance.
+ Per-chain measurements are written to `data/proposal_tuning.dat` and the weight
+ history is appended to `data/proposal_weights.dat`.
+ */
+void tune_proposal_weights(struct Proposal **proposal, struct Chain *chain, struct Flags *flags, int step);
+
 /**
 \brief Shift start time of data segment
  
@@ -194,7 +224,7 @@ double draw_from_cov(UNUSED struct Data *data, struct Model *model, struct Sourc
 /**
  \brief Draw from 3D F-statistic distribution
  
- Uses pre-computed 3D quantized distribution to draw \f$[f_0,\cos\theta,\phi]\f$ weighted by F-statistic likelihood in each cell. Remaining parameters are drawn from the prior.
+ Uses pre-computed 3D quantized distribution to draw \f$[f_0,\cos\theta,\phi]\f$ weighted by F-statistic likelihood in each cell. Cells are chosen by binary search of the cumulative table in Proposal::vector. Remaining parameters are drawn from the prior.
  
  @param params (updates \f$\vec\theta\f$)
  @return logQ = evaluate_fstatistic_proposal()
@@ -18,13 +18,12 @@
  */
 
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <sys/stat.h>
 
-#include <gsl/gsl_fft_complex.h>
-
 #include <LISA.h>
 
 #include "GalacticBinary.h"
@@ -66,93 +65,232 @@ double galactic_binary_dL(double f0, double dfdt, double A)
     return ((5./48.)*(fd/(M_PI*M_PI*f*f*f*amp))*CLIGHT/PC); //seconds  !check notes on 02/28!
 }
 
+/**
+ \brief Scratch space for galactic_binary_fisher()
+ 
+ Parameter derivatives, polarization basis, and perturbed templates of each
+ TDI channel (X,A,E), holding only the `2*BW` samples of the source bandwidth.
+ */
+struct GBFisherWorkspace
+{
+    int BWmax;
+    int NPmax;
+    double *invSn[3];    //!<inverse noise PSD over the source bandwidth
+    double **dh[3];      //!<`dh[c][i]` derivative of channel c w.r.t. parameter i
+    double *basis[3][2]; //!<`basis[c][0]` plus and `basis[c][1]` cross response of channel c
+    double **wave[3];    //!<`wave[c][b]` perturbed template b for channel c
+    double **params;     //!<`params[b]` parameters of perturbed template b
+};
+
+static struct GBFisherWorkspace *alloc_fisher_workspace(int BWmax, int NPmax)
+{
+    struct GBFisherWorkspace *workspace = malloc(sizeof(struct GBFisherWorkspace));
+    workspace->BWmax = BWmax;
+    workspace->NPmax = NPmax;
+    for(int c=0; c<3; c++)
+    {
+        workspace->invSn[c]    = calloc(BWmax,sizeof(double));
+        workspace->basis[c][0] = calloc(2*BWmax,sizeof(double));
+        workspace->basis[c][1] = calloc(2*BWmax,sizeof(double));
+        workspace->dh[c]   = malloc(NPmax*sizeof(double *));
+        workspace->wave[c] = malloc(2*NPmax*sizeof(double *));
+        for(int i=0; i<NPmax; i++)   workspace->dh[c][i]   = calloc(2*BWmax,sizeof(double));
+        for(int i=0; i<2*NPmax; i++) workspace->wave[c][i] = calloc(2*BWmax,sizeof(double));
+    }
+    workspace->params = malloc(2*NPmax*sizeof(double *));
+    for(int i=0; i<2*NPmax; i++) workspace->params[i] = calloc(NPmax,sizeof(double));
+    return workspace;
+}
+
+static void free_fisher_workspace(struct GBFisherWorkspace *workspace)
+{
+    for(int c=0; c<3; c++)
+    {
+        for(int i=0; i<workspace->NPmax; i++)   free(workspace->dh[c][i]);
+        for(int i=0; i<2*workspace->NPmax; i++) free(workspace->wave[c][i]);
+        free(workspace->dh[c]);
+        free(workspace->wave[c]);
+        free(workspace->invSn[c]);
+        free(workspace->basis[c][0]);
+        free(workspace->basis[c][1]);
+    }
+    for(int i=0; i<2*workspace->NPmax; i++) free(workspace->params[i]);
+    free(workspace->params);
+    free(workspace);
+}
+
+/* one Fisher workspace per OpenMP thread, grown on demand */
+static struct GBFisherWorkspace *fisher_workspace = NULL;
+#pragma omp threadprivate(fisher_workspace)
+
+static struct GBFisherWorkspace *get_fisher_workspace(int BW, int NP)
+{
+    if(fisher_workspace != NULL && (fisher_workspace->BWmax < BW || fisher_workspace->NPmax < NP))
+    {
+        if(fisher_workspace->BWmax > BW) BW = fisher_workspace->BWmax;
+        if(fisher_workspace->NPmax > NP) NP = fisher_workspace->NPmax;
+        free_fisher_workspace(fisher_workspace);
+        fisher_workspace = NULL;
+    }
+    if(fisher_workspace == NULL) fisher_workspace = alloc_fisher_workspace(BW, NP);
+    return fisher_workspace;
+}
+
+/*
+ The waveform is h = z+ h+ + zx hx, with h+ and hx from galactic_binary_polarizations() and
+ complex weights z+ = exp(-i phi0)(DPr + i DPi), zx = exp(-i phi0)(DCr + i DCi)
+ (see set_template_constants()).  This returns dz/dparams[n] for the
+ extrinsic parameters n = 3 (log amplitude), 4 (cos inclination), 5 (polarization), 6 (phase).
+ */
+static void polarization_weight_derivative(double *params, int n, double *dzp, double *dzc)
+{
+    double amp  = exp(params[3]);
+    double cosi = params[4];
+    double c2   = cos(2.*params[5]);
+    double s2   = sin(2.*params[5]);
+    double cph  = cos(params[6]);
+    double sph  = sin(params[6]);
+    
+    double Aplus  =  amp*(1.+cosi*cosi);
+    double Across = -amp*(2.0*cosi);
+    
+    //derivatives of DPr + i DPi and DCr + i DCi
+    double wp[2], wc[2];
+    switch(n)
+    {
+        case 3:
+            wp[0] =  Aplus*c2;         wp[1] = -Across*s2;
+            wc[0] = -Aplus*s2;         wc[1] = -Across*c2;
+            break;
+        case 4:
+            wp[0] =  2.*amp*cosi*c2;   wp[1] =  2.*amp*s2;
+            wc[0] = -2.*amp*cosi*s2;   wc[1] =  2.*amp*c2;
+            break;
+        case 5:
+            wp[0] = -2.*Aplus*s2;      wp[1] = -2.*Across*c2;
+            wc[0] = -2.*Aplus*c2;      wc[1] =  2.*Across*s2;
+            break;
+        case 6:
+            //d/dphi0 exp(-i phi0) = -i exp(-i phi0)
+            wp[0] = -Across*s2;        wp[1] = -Aplus*c2;
+            wc[0] = -Across*c2;        wc[1] =  Aplus*s2;
+            break;
+        default:
+            wp[0] = wp[1] = wc[0] = wc[1] = 0.0;
+            break;
+    }
+    
+    //multiply by exp(-i phi0)
+    dzp[0] = cph*wp[0] + sph*wp[1];
+    dzp[1] = cph*wp[1] - sph*wp[0];
+    dzc[0] = cph*wc[0] + sph*wc[1];
+    dzc[1] = cph*wc[1] - sph*wc[0];
+}
+
 void galactic_binary_fisher(struct Orbit *orbit, struct Data *data, struct Source *source, struct Noise *noise)
 {
     //TODO:  galactic_binary_fisher should compute joint Fisher
-    int i,j,n;
+    int i,j,n,m;
     
     int NP = source->NP;
+    int NI = source->tdi->Nchannel;
+    double T = data->T;
     
     double epsilon    = 1.0e-7;
     double invepsilon2= 1./(2.*epsilon);
-    double invstep;
     
-    // Plus and minus parameters:
-    double *params_p = calloc(NP,sizeof(double));
-    double *params_m = calloc(NP,sizeof(double));
+    //TDI channels used for the inner products (X, or A&E)
+    int Nc = (NI==1) ? 1 : 2;
+    int channel[2] = {1, 2};
+    if(NI==1) channel[0] = 0;
+    double *Sn[3] = {noise->SnX, noise->SnA, noise->SnE};
     
-    // Plus and minus templates for each detector:
-    struct Source *wave_p = malloc(sizeof(struct Source));
-    struct Source *wave_m = malloc(sizeof(struct Source));
-    alloc_source(wave_p, data->N, data->Nchannel, NP);
-    alloc_source(wave_m, data->N, data->Nchannel, NP);
+    /* bandwidth and location of the source in the data segment */
+    double f0   = source->params[0]/T;
+    double dfdt = (NP>7) ? source->params[7]/(T*T) : 0.0;
+    int BW   = 2*galactic_binary_bandwidth(orbit->L, orbit->fstar, f0, dfdt, source->params[1], exp(source->params[3]), T, data->N);
+    int imin = (int)(f0*T) - BW/2 - data->qmin;
     
-    // TDI variables to hold derivatives of h
-    struct TDI **dhdx = malloc(NP*sizeof(struct TDI *));
-    for(n=0; n<NP; n++)
+    struct GBFisherWorkspace *workspace = get_fisher_workspace(BW, NP);
+    
+    /* inverse noise at the frequency bins covered by the source */
+    for(m=0; m<Nc; m++)
     {
-        dhdx[n] = malloc(sizeof(struct TDI));
-        alloc_tdi(dhdx[n], data->N, data->Nchannel);
+        int c = channel[m];
+        for(n=0; n<BW; n++)
+        {
+            int k = imin + n;
+            if(k<0) k = 0;
+            if(k>data->N-1) k = data->N-1;
+            workspace->invSn[c][n] = 1./Sn[c][k];
+        }
     }
     
-    /* assumes all the parameters are log or angle */
-    int N2 = data->N*2;
-    for(i=0; i<NP; i++)
+    /*
+     Extrinsic parameters only set the weights of the plus and cross responses,
+     so their derivatives are closed-form combinations of the polarization basis.
+     The "phase" TDI channels are returned complex conjugated, and so are the weights.
+     */
+    galactic_binary_polarizations(orbit, data->format, T, data->t0[0], source->params, NP,
+                                  workspace->basis[0][0], workspace->basis[1][0], workspace->basis[2][0],
+                                  workspace->basis[0][1], workspace->basis[1][1], workspace->basis[2][1],
+                                  BW, NI);
+    
+    double conj = (strcmp("phase",data->format) == 0) ? -1.0 : 1.0;
+    
+    for(i=3; i<=6; i++)
     {
-        //step size for derivatives
-        invstep = invepsilon2;
+        double dzp[2], dzc[2];
+        polarization_weight_derivative(source->params, i, dzp, dzc);
+        dzp[1] *= conj;
+        dzc[1] *= conj;
         
-        // copy parameters
-        for(j=0; j<NP; j++)
+        for(m=0; m<Nc; m++)
         {
-            wave_p->params[j] = source->params[j];
-            wave_m->params[j] = source->params[j];
+            int c = channel[m];
+            double *hp = workspace->basis[c][0];
+            double *hc = workspace->basis[c][1];
+            double *dh = workspace->dh[c][i];
+            for(n=0; n<BW; n++)
+            {
+                int re = 2*n;
+                int im = 2*n+1;
+                dh[re] = dzp[0]*hp[re] - dzp[1]*hp[im] + dzc[0]*hc[re] - dzc[1]*hc[im];
+                dh[im] = dzp[0]*hp[im] + dzp[1]*hp[re] + dzc[0]*hc[im] + dzc[1]*hc[re];
+            }
         }
+    }
+    
+    /* intrinsic parameters by central differencing, with all perturbed templates in one batch */
+    int Nbatch = 0;
+    for(i=0; i<NP; i++)
+    {
+        if(i>=3 && i<=6) continue;
         
-        // perturb parameters
-        wave_p->params[i] += epsilon;
-        wave_m->params[i] -= epsilon;
-        
-        // complete info in source structure
-        map_array_to_params(wave_p, wave_p->params, data->T);
-        map_array_to_params(wave_m, wave_m->params, data->T);
-        
-        // clean up TDI arrays, just in case
-        for(j=0; j<N2; j++)
+        for(j=0; j<NP; j++)
         {
-            wave_p->tdi->X[j]=0.0;
-            wave_p->tdi->A[j]=0.0;
-            wave_p->tdi->E[j]=0.0;
-            wave_m->tdi->X[j]=0.0;
-            wave_m->tdi->A[j]=0.0;
-            wave_m->tdi->E[j]=0.0;
+            workspace->params[Nbatch][j]   = source->params[j];
+            workspace->params[Nbatch+1][j] = source->params[j];
         }
+        workspace->params[Nbatch][i]   += epsilon;
+        workspace->params[Nbatch+1][i] -= epsilon;
+        Nbatch += 2;
+    }
+    galactic_binary_batch(orbit, data->format, T, data->t0[0], workspace->params, NP, Nbatch, workspace->wave[0], workspace->wave[1], workspace->wave[2], BW, NI);
+    
+    for(i=0, n=0; i<NP; i++)
+    {
+        if(i>=3 && i<=6) continue;
         
-        // align perturbed waveforms in data array
-        galactic_binary_alignment(orbit, data, wave_p);
-        galactic_binary_alignment(orbit, data, wave_m);
-        
-        // compute perturbed waveforms
-        galactic_binary(orbit, data->format, data->T, data->t0[0], wave_p->params, NP, wave_p->tdi->X, wave_p->tdi->A, wave_p->tdi->E, wave_p->BW, wave_p->tdi->Nchannel);
-        galactic_binary(orbit, data->format, data->T, data->t0[0], wave_m->params, NP, wave_m->tdi->X, wave_m->tdi->A, wave_m->tdi->E, wave_m->BW, wave_m->tdi->Nchannel);
-        
-        // central differencing derivatives of waveforms w.r.t. parameters
-        switch(source->tdi->Nchannel)
+        for(m=0; m<Nc; m++)
         {
-            case 1:
-                for(n=0; n<N2; n++)
-                {
-                    dhdx[i]->X[n] = (wave_p->tdi->X[n] - wave_m->tdi->X[n])*invstep;
-                }
-                break;
-            case 2:
-                for(n=0; n<N2; n++)
-                {
-                    dhdx[i]->A[n] = (wave_p->tdi->A[n] - wave_m->tdi->A[n])*invstep;
-                    dhdx[i]->E[n] = (wave_p->tdi->E[n] - wave_m->tdi->E[n])*invstep;
-                }
-                break;
+            int c = channel[m];
+            double *wp = workspace->wave[c][n];
+            double *wm = workspace->wave[c][n+1];
+            double *dh = workspace->dh[c][i];
+            for(j=0; j<2*BW; j++) dh[j] = (wp[j] - wm[j])*invepsilon2;
         }
+        n += 2;
     }
     
     // Calculate fisher matrix
@@ -161,15 +299,15 @@ void galactic_binary_fisher(struct Orbit *orbit, struct Data *data, struct Sourc
         for(j=i; j<NP; j++)
         {
             //source->fisher_matrix[i][j] = 10.0; //fisher gets a "DC" level to keep the inversion stable
-            switch(source->tdi->Nchannel)
+            for(m=0; m<Nc; m++)
             {
-                case 1:
-                    source->fisher_matrix[i][j] += fourier_nwip(dhdx[i]->X, dhdx[j]->X, noise->SnX, data->N);
-                    break;
-                case 2:
-                    source->fisher_matrix[i][j] += fourier_nwip(dhdx[i]->A, dhdx[j]->A, noise->SnA, data->N);
-                    source->fisher_matrix[i][j] += fourier_nwip(dhdx[i]->E, dhdx[j]->E, noise->SnE, data->N);
-                    break;
+                int c = channel[m];
+                double *a = workspace->dh[c][i];
+                double *b = workspace->dh[c][j];
+                double *invSn = workspace->invSn[c];
+                double sum = 0.0;
+                for(n=0; n<BW; n++) sum += (a[2*n]*b[2*n] + a[2*n+1]*b[2*n+1])*invSn[n];
+                source->fisher_matrix[i][j] += 2.0*sum;
             }
             if(source->fisher_matrix[i][j]!=source->fisher_matrix[i][j])
             {
@@ -188,13 +326,70 @@ void galactic_binary_fisher(struct Orbit *orbit, struct Data *data, struct Sourc
     // Calculate eigenvalues and eigenvectors of fisher matrix
     matrix_eigenstuff(source->fisher_matrix, source->fisher_evectr, source->fisher_evalue, NP);
     
-    free(params_p);
-    free(params_m);
-    free_source(wave_p);
-    free_source(wave_m);
+    // Remember where the matrix was computed for galactic_binary_fisher_stale()
+    memcpy(source->fisher_params, source->params, NP*sizeof(double));
+    source->fisher_trial  = 0;
+    source->fisher_accept = 0;
+}
+
+/*
+ Fisher matrix refresh policy.  A source's matrix is stale if it has moved
+ more than FISHER_DRIFT (temperature scaled) standard deviations per
+ parameter from where it was computed, or if draw_from_fisher() has been
+ accepted less than FISHER_MIN_ACCEPT of the last FISHER_MIN_TRIALS tries.
+ */
+#define FISHER_DRIFT 2.0
+#define FISHER_MIN_TRIALS 1000
+#define FISHER_MIN_ACCEPT 0.05
+
+/*
+ Eigenvalues draw_from_fisher() can use are positive and finite.  Tested on
+ the bit pattern because -ffast-math folds isnan()/isfinite() away.
+ */
+static int fisher_evalue_usable(double evalue)
+{
+    uint64_t bits;
+    memcpy(&bits, &evalue, sizeof(double));
+    
+    uint64_t sign = bits >> 63;
+    uint64_t exponent = (bits >> 52) & 0x7ff;
     
-    for(n=0; n<NP; n++) free_tdi(dhdx[n]);
-    free(dhdx);
+    return (sign == 0 && exponent != 0x7ff && bits != 0);
+}
+
+int galactic_binary_fisher_distance(struct Source *source, double *params, double *d2)
+{
+    int NP = source->NP;
+    
+    *d2 = 0.0;
+    for(int i=0; i<NP; i++) if(!fisher_evalue_usable(source->fisher_evalue[i])) return 0;
+    
+    for(int i=0; i<NP; i++)
+    {
+        double x = 0.0;
+        for(int j=0; j<NP; j++) x += source->fisher_evectr[j][i]*(params[j] - source->fisher_params[j]);
+        *d2 += source->fisher_evalue[i]*x*x;
+    }
+    
+    return 1;
+}
+
+int galactic_binary_fisher_stale(struct Source *source, double temperature)
+{
+    int NP = source->NP;
+    
+    //never computed, or eigenvalues draw_from_fisher() can't use
+    for(int i=0; i<NP; i++) if(!fisher_evalue_usable(source->fisher_evalue[i])) return 1;
+    
+    //distance from last update measured by the Fisher matrix itself
+    double d2;
+    galactic_binary_fisher_distance(source, source->params, &d2);
+    
+    //acceptance of Fisher jumps since the last update
+    if(source->fisher_trial >= FISHER_MIN_TRIALS &&
+       source->fisher_accept < FISHER_MIN_ACCEPT*source->fisher_trial) return 1;
+    
+    return (d2 > FISHER_DRIFT*FISHER_DRIFT*NP*temperature);
 }
 
 
@@ -238,96 +433,133 @@ void galactic_binary_alignment(struct Orbit *orbit, struct Data *data, struct So
     source->imax = source->imin + source->BW;  
 }
 
-void galactic_binary(struct Orbit *orbit, char *format, double T, double t0, double *params, int NP, double *X, double *A, double *E, int BW, int NI)
+/**
+ \brief Sky, polarization and phase constants of one template in a batch
+ */
+struct GBTemplate
 {
-    /*   Indicies   */
-    int i,j,n;
-    /*   Carrier frequency bin  */
+    double f0, dfdt, d2fdt2, phi0;
     long q;
-    /*   Bandwidth      */
-    int BW2   = BW*2;
-    double invBW2 = 1./(double)BW2;
-    
-    /*   Gravitational Wave basis vectors   */
-    double u[4],v[4],k[4];
-    /*   Polarization basis tensors   */
-    double eplus[4][4], ecross[4][4];
-    /*   Spacecraft position and separation vector   */
-    double *x, *y, *z;
-    double r12[4]={0},r13[4]={0},r23[4]={0};
-    /*   Dot products   */
-    double kdotx[4]={0},kdotr[4][4];
-    /*   Convenient quantities   */
-    double dplus[4][4],dcross[4][4];
-    /*   GW source parameters   */
-    double phi, psi, amp, Aplus, Across, f0, dfdt, d2fdt2, phi0;
-    double costh, sinth, cosph, sinph, cosi, cosps, sinps;
-    /*   Time and distance variables   */
-    double t, xi[4] = {0};
-    /*   Gravitational wave frequency & ratio of f and transfer frequency f*  */
-    double f[4] = {0},fonfs[4] = {0};
-    /*   LISA response to slow terms (Real & Imaginary pieces)   */
-    //Static quantities (Re and Im)
-    double DPr, DPi, DCr, DCi;
-    //Time varrying quantities (Re & Im) broken up into convenient segments
-    double TR[4][4], TI[4][4];
-    //Miscellaneous constants used to speed up calculations
     double df;
-    /*   Fourier coefficients before FFT and after convolution  */
-    //Time series of slowly evolving terms at each vertex
-    double *data12, *data13, *data21, *data23, *data31, *data32;
-    //Fourier coefficients of slowly evolving terms (numerical)
-    double a12[BW2+3], a13[BW2+3], a21[BW2+3], a23[BW2+3], a31[BW2+3], a32[BW2+3];
-    //Package cij's into proper form for TDI subroutines
-    double ***d;
-    
-    /*   Allocating Arrays   */
-    x = calloc(4,sizeof(double));
-    y = calloc(4,sizeof(double));
-    z = calloc(4,sizeof(double));
-    
-    data12 = calloc((BW2+1),sizeof(double));
-    data21 = calloc((BW2+1),sizeof(double));
-    data31 = calloc((BW2+1),sizeof(double));
-    data13 = calloc((BW2+1),sizeof(double));
-    data23 = calloc((BW2+1),sizeof(double));
-    data32 = calloc((BW2+1),sizeof(double));
-    
-    d = malloc(sizeof(double**)*4);
-    for(i=0; i<4; i++)
+    double k[4];
+    double eplus[6], ecross[6]; //!<polarization tensors packed as (11,22,33,2*12,2*13,2*23)
+    double DPr, DPi, DCr, DCi;
+};
+
+void alloc_waveform_workspace(struct GBWaveformWorkspace *workspace, int BWmax, int Nmax)
+{
+    workspace->BWmax = BWmax;
+    workspace->Nmax  = Nmax;
+    workspace->templates = calloc(Nmax,sizeof(struct GBTemplate));
+    workspace->d = malloc(sizeof(double***)*Nmax);
+    for(int b=0; b<Nmax; b++)
+    {
+        workspace->d[b] = malloc(sizeof(double**)*4);
+        for(int i=0; i<4; i++)
+        {
+            workspace->d[b][i] = malloc(sizeof(double*)*4);
+            for(int j=0; j<4; j++) workspace->d[b][i][j] = calloc((2*BWmax+1),sizeof(double));
+        }
+    }
+}
+
+void free_waveform_workspace(struct GBWaveformWorkspace *workspace)
+{
+    for(int b=0; b<workspace->Nmax; b++)
     {
-        d[i] = malloc(sizeof(double*)*4);
-        for(j=0; j<4; j++)
+        for(int i=0; i<4; i++)
         {
-            	d[i][j] = calloc((BW2+1),sizeof(double));
-		dplus[i][j] = 0.0;
-		dcross[i][j] = 0.0;
-		eplus[i][j] = 0.0;
-		ecross[i][j] = 0.0;
-		kdotr[i][j] = 0.0;
-		TR[i][j] = 0.0;
-		TI[i][j] = 0.0;
+            for(int j=0; j<4; j++) free(workspace->d[b][i][j]);
+            free(workspace->d[b][i]);
         }
+        free(workspace->d[b]);
+    }
+    free(workspace->d);
+    free(workspace->templates);
+    free(workspace);
+}
+
+/* one waveform workspace per OpenMP thread, grown on demand */
+static struct GBWaveformWorkspace *waveform_workspace = NULL;
+#pragma omp threadprivate(waveform_workspace)
+
+struct GBWaveformWorkspace *get_waveform_workspace(int BW, int Nbatch)
+{
+    if(waveform_workspace != NULL && (waveform_workspace->BWmax < BW || waveform_workspace->Nmax < Nbatch))
+    {
+        if(waveform_workspace->BWmax > BW)     BW     = waveform_workspace->BWmax;
+        if(waveform_workspace->Nmax  > Nbatch) Nbatch = waveform_workspace->Nmax;
+        free_waveform_workspace(waveform_workspace);
+        waveform_workspace = NULL;
+    }
+    if(waveform_workspace == NULL)
+    {
+        waveform_workspace = malloc(sizeof(struct GBWaveformWorkspace));
+        alloc_waveform_workspace(waveform_workspace, BW, Nbatch);
+    }
+    return waveform_workspace;
+}
+
+/*
+ Transfer function phase arg1 = (f/2f*)(1+k.r) is small for most UCBs.
+ Below TRANSFER_SERIES_MAX the Taylor series through x^13 (sin) and x^14 (cos)
+ has truncation error < 1e-16, so it replaces the libm calls without loss of accuracy.
+ The direct libm evaluation of exp(i(arg1+arg2)) is kept as a reference, see
+ galactic_binary_reference_transfer().
+ */
+#define TRANSFER_SERIES_MAX 0.5
+
+static int transfer_reference = 0;
+
+void galactic_binary_reference_transfer(int reference)
+{
+    transfer_reference = reference;
+}
+
+static inline void transfer_sincos(double x, double *s, double *c)
+{
+    if(fabs(x) < TRANSFER_SERIES_MAX)
+    {
+        double x2 = x*x;
+        *s = x*(1. - x2/6.*(1. - x2/20.*(1. - x2/42.*(1. - x2/72.*(1. - x2/110.*(1. - x2/156.))))));
+        *c = 1. - x2/2.*(1. - x2/12.*(1. - x2/30.*(1. - x2/56.*(1. - x2/90.*(1. - x2/132.*(1. - x2/182.))))));
     }
+    else
+    {
+        *s = sin(x);
+        *c = cos(x);
+    }
+}
+
+static void set_template_constants(struct GBTemplate *tmpl, double *params, int NP, double T)
+{
+    int i,j;
     
-    /*   Gravitational Wave source parameters   */
+    /*   Gravitational Wave basis vectors   */
+    double u[4],v[4];
+    /*   Polarization basis tensors   */
+    double eplus[4][4], ecross[4][4];
+    
+    /*   GW source parameters   */
+    double phi, psi, amp, Aplus, Across;
+    double costh, sinth, cosph, sinph, cosi, cosps, sinps;
     
-    f0     = params[0]/T;
-    costh  = params[1];
-    phi    = params[2];
-    amp    = exp(params[3]);
-    cosi   = params[4];
-    psi    = params[5];
-    phi0   = params[6];
-    dfdt   = 0.0;
-    d2fdt2 = 0.0;
+    tmpl->f0     = params[0]/T;
+    costh        = params[1];
+    phi          = params[2];
+    amp          = exp(params[3]);
+    cosi         = params[4];
+    psi          = params[5];
+    tmpl->phi0   = params[6];
+    tmpl->dfdt   = 0.0;
+    tmpl->d2fdt2 = 0.0;
     if(NP>7)
-        dfdt   = params[7]/(T*T);
+        tmpl->dfdt   = params[7]/(T*T);
     if(NP>8)
-        d2fdt2 = params[8]/(T*T*T);
+        tmpl->d2fdt2 = params[8]/(T*T*T);
     
     //Calculate carrier frequency bin
-    q = (long)(f0*T);
+    tmpl->q = (long)(tmpl->f0*T);
     
     //Calculate cos and sin of sky position, inclination, polarization
     sinth	= sqrt(1.0 - costh*costh); //sin(theta) >= 0 (theta -> 0,pi)
@@ -340,19 +572,20 @@ void galactic_binary(struct Orbit *orbit, char *format, double T, double t0, dou
     Aplus  =  amp*(1.+cosi*cosi);
     Across = -amp*(2.0*cosi);
     
-    df = PI2*(((double)q)/T);
+    tmpl->df = PI2*(((double)tmpl->q)/T);
     
     //Calculate constant pieces of transfer functions
-    DPr =  Aplus*cosps;
-    DPi = -Across*sinps;
-    DCr = -Aplus*sinps;
-    DCi = -Across*cosps;
+    tmpl->DPr =  Aplus*cosps;
+    tmpl->DPi = -Across*sinps;
+    tmpl->DCr = -Aplus*sinps;
+    tmpl->DCi = -Across*cosps;
     
     /*   Tensor construction for buildingslowly evolving LISA response   */
     //Gravitational Wave source basis vectors
     u[1] =  costh*cosph;  u[2] =  costh*sinph;  u[3] = -sinth;
     v[1] =  sinph;        v[2] = -cosph;        v[3] =  0.;
-    k[1] = -sinth*cosph;  k[2] = -sinth*sinph;  k[3] = -costh;
+    tmpl->k[0] = 0.0;
+    tmpl->k[1] = -sinth*cosph;  tmpl->k[2] = -sinth*sinph;  tmpl->k[3] = -costh;
     
     //GW polarization basis tensors
     /*
@@ -368,199 +601,309 @@ void galactic_binary(struct Orbit *orbit, char *format, double T, double t0, dou
         }
     }
     
+    //Pack symmetric tensors for contraction with the arm projection tensors in OrbitCache
+    tmpl->eplus[0]  = eplus[1][1];      tmpl->ecross[0] = ecross[1][1];
+    tmpl->eplus[1]  = eplus[2][2];      tmpl->ecross[1] = ecross[2][2];
+    tmpl->eplus[2]  = eplus[3][3];      tmpl->ecross[2] = ecross[3][3];
+    tmpl->eplus[3]  = 2.*eplus[1][2];   tmpl->ecross[3] = 2.*ecross[1][2];
+    tmpl->eplus[4]  = 2.*eplus[1][3];   tmpl->ecross[4] = 2.*ecross[1][3];
+    tmpl->eplus[5]  = 2.*eplus[2][3];   tmpl->ecross[5] = 2.*ecross[2][3];
+}
+
+void galactic_binary(struct Orbit *orbit, char *format, double T, double t0, double *params, int NP, double *X, double *A, double *E, int BW, int NI)
+{
+    galactic_binary_batch(orbit, format, T, t0, &params, NP, 1, &X, &A, &E, BW, NI);
+}
+
+/*
+ Polarization-independent part of the slowly evolving response of each link
+ at time sample n: the projections d+ and dx of the arm tensors onto the
+ polarization basis, and G[i][j] = sinc*aevol*exp(i(arg1+arg2)) with phi0 included.
+ The link response is then (d+ (DPr + i DPi) + dx (DCr + i DCi)) G.
+ */
+static void template_transfer(struct Orbit *orbit, struct OrbitCache *cache, struct GBTemplate *tmpl, int NP, int n, double t, double dplus[4][4], double dcross[4][4], double GR[4][4], double GI[4][4])
+{
+    int i,j;
     
-    /* Main loop over signal bandwidth */
-    for(n=1; n<=BW; n++)
+    /*   Spacecraft position and separation vector   */
+    double *x = cache->x[n-1], *y = cache->y[n-1], *z = cache->z[n-1];
+    double *r12 = cache->r12[n-1], *r13 = cache->r13[n-1], *r23 = cache->r23[n-1];
+    
+    /*   Projection tensors of each arm   */
+    double *rr12 = cache->rr12[n-1], *rr13 = cache->rr13[n-1], *rr23 = cache->rr23[n-1];
+    
+    /*   Dot products   */
+    double kdotx[4]={0},kdotr[4][4]={{0}};
+    /*   Time and distance variables   */
+    double xi[4] = {0};
+    /*   Gravitational wave frequency & ratio of f and transfer frequency f*  */
+    double f[4] = {0},fonfs[4] = {0};
+    
+    double *k = tmpl->k;
+    
+    for(i=1; i<=3; i++)
     {
-        //First time sample must be at t=0 for phasing
-        t = t0 + T*(double)(n-1)/(double)BW;
+        kdotx[i] = (x[i]*k[1]+y[i]*k[2]+z[i]*k[3])/CLIGHT;
         
-        //Calculate position of each spacecraft at time t
-        (*orbit->orbit_function)(orbit, t, x, y, z);
+        //Wave arrival time at spacecraft i
+        xi[i] = t - kdotx[i];
         
-        for(i=1; i<=3; i++)
-        {
-            kdotx[i] = (x[i]*k[1]+y[i]*k[2]+z[i]*k[3])/CLIGHT;
-            
-            //Wave arrival time at spacecraft i
-            xi[i] = t - kdotx[i];
-            
-            //Zeroeth order approximation to frequency at spacecraft i
-            f[i] = f0;
-            
-            //First order in frequency
-            if(NP>7) f[i] += dfdt*xi[i];
-            
-            //Second order in frequency
-            if(NP>8) f[i] += 0.5*d2fdt2*xi[i]*xi[i];
-            
-            //Ratio of true frequency to transfer frequency
-            fonfs[i] = f[i]/orbit->fstar;
-        }
+        //Zeroeth order approximation to frequency at spacecraft i
+        f[i] = tmpl->f0;
         
+        //First order in frequency
+        if(NP>7) f[i] += tmpl->dfdt*xi[i];
         
-        //Unit separation vector from spacecrafts i to j
-        r12[1] = (x[2] - x[1])/orbit->L;   r13[1] = (x[3] - x[1])/orbit->L;   r23[1] = (x[3] - x[2])/orbit->L;
-        r12[2] = (y[2] - y[1])/orbit->L;   r13[2] = (y[3] - y[1])/orbit->L;   r23[2] = (y[3] - y[2])/orbit->L;
-        r12[3] = (z[2] - z[1])/orbit->L;   r13[3] = (z[3] - z[1])/orbit->L;   r23[3] = (z[3] - z[2])/orbit->L;
+        //Second order in frequency
+        if(NP>8) f[i] += 0.5*tmpl->d2fdt2*xi[i]*xi[i];
         
+        //Ratio of true frequency to transfer frequency
+        fonfs[i] = f[i]/orbit->fstar;
+    }
+    
+    //Zero arrays to be summed
+    dplus[1][2]  = dplus[1][3]  = dplus[2][1]  = dplus[2][3]  = dplus[3][1]  = dplus[3][2]  = 0.;
+    dcross[1][2] = dcross[1][3] = dcross[2][1] = dcross[2][3] = dcross[3][1] = dcross[3][2] = 0.;
+    
+    //Convenient quantities d+ & dx
+    for(i=0; i<6; i++)
+    {
+        dplus[1][2]  += rr12[i]*tmpl->eplus[i];   dcross[1][2] += rr12[i]*tmpl->ecross[i];
+        dplus[2][3]  += rr23[i]*tmpl->eplus[i];   dcross[2][3] += rr23[i]*tmpl->ecross[i];
+        dplus[1][3]  += rr13[i]*tmpl->eplus[i];   dcross[1][3] += rr13[i]*tmpl->ecross[i];
+    }
+    
+    //Make use of symmetry
+    dplus[2][1] = dplus[1][2];  dcross[2][1] = dcross[1][2];
+    dplus[3][2] = dplus[2][3];  dcross[3][2] = dcross[2][3];
+    dplus[3][1] = dplus[1][3];  dcross[3][1] = dcross[1][3];
+    
+    //Zero arrays to be summed
+    kdotr[1][2] = kdotr[1][3] = kdotr[2][1] = kdotr[2][3] = kdotr[3][1] = kdotr[3][2] = 0.;
+    for(i=1; i<=3; i++)
+    {
+        kdotr[1][2] += k[i]*r12[i];   kdotr[1][3] += k[i]*r13[i];   kdotr[2][3] += k[i]*r23[i];
+    }
+    
+    //Make use of antisymmetry
+    kdotr[2][1] = -kdotr[1][2];
+    kdotr[3][1] = -kdotr[1][3];
+    kdotr[3][2] = -kdotr[2][3];
+    
+    //Calculating Transfer function
+    for(i=1; i<=3; i++)
+    {
+        //Argument of complex exponentials
+        /*
+         * LDC phase parameter in key files is
+         * -phi0, hence the -phi0 in arg2
+         */
+        double arg2 = PI2*tmpl->f0*xi[i] - tmpl->phi0 - tmpl->df*t;
         
-        //Zero arrays to be summed
-        dplus[1][2]  = dplus[1][3]  = dplus[2][1]  = dplus[2][3]  = dplus[3][1]  = dplus[3][2]  = 0.;
-        dcross[1][2] = dcross[1][3] = dcross[2][1] = dcross[2][3] = dcross[3][1] = dcross[3][2] = 0.;
         
-        //Convenient quantities d+ & dx
-        for(i=1; i<=3; i++)
-        {
-            for(j=1; j<=3; j++)
-            {
-                dplus[1][2]  += r12[i]*r12[j]*eplus[i][j];   dcross[1][2] += r12[i]*r12[j]*ecross[i][j];
-                dplus[2][3]  += r23[i]*r23[j]*eplus[i][j];   dcross[2][3] += r23[i]*r23[j]*ecross[i][j];
-                dplus[1][3]  += r13[i]*r13[j]*eplus[i][j];   dcross[1][3] += r13[i]*r13[j]*ecross[i][j];
-            }
-        }
+        //First order frequency evolution
+        if(NP>7) arg2 += M_PI*tmpl->dfdt*xi[i]*xi[i];
         
-        //Make use of symmetry
-        dplus[2][1] = dplus[1][2];  dcross[2][1] = dcross[1][2];
-        dplus[3][2] = dplus[2][3];  dcross[3][2] = dcross[2][3];
-        dplus[3][1] = dplus[1][3];  dcross[3][1] = dcross[1][3];
+        //Second order frequency evolution
+        if(NP>8) arg2 += (M_PI/3.0)*tmpl->d2fdt2*xi[i]*xi[i]*xi[i];
         
-        //Zero arrays to be summed
-        kdotr[1][2] = kdotr[1][3] = kdotr[2][1] = kdotr[2][3] = kdotr[3][1] = kdotr[3][2] = 0.;
-        for(i=1; i<=3; i++)
-        {
-            kdotr[1][2] += k[i]*r12[i];   kdotr[1][3] += k[i]*r13[i];   kdotr[2][3] += k[i]*r23[i];
-        }
+        //Complex exponential of the source phase, combined with each link's transfer phase below
+        double cos2 = cos(arg2);
+        double sin2 = sin(arg2);
         
-        //Make use of antisymmetry
-        kdotr[2][1] = -kdotr[1][2];
-        kdotr[3][1] = -kdotr[1][3];
-        kdotr[3][2] = -kdotr[2][3];
+        //Evolution of amplitude
+        double aevol = 1.0;
         
-        //Calculating Transfer function
-        for(i=1; i<=3; i++)
+        //First order amplitude evolution
+        if(NP>7) aevol += 0.66666666666666666666*tmpl->dfdt/tmpl->f0*xi[i];
+        
+        //Second order amplitude evolution
+        //if(NP>8) aevol += const.*d2fdt2*xi[i]*xi[i]/f0;
+        
+        for(j=1; j<=3; j++)
         {
-            //Argument of complex exponentials
-            /*
-             * LDC phase parameter in key files is
-             * -phi0, hence the -phi0 in arg2
-             */
-            double arg2 = PI2*f0*xi[i] - phi0 - df*t;
-            
-            
-            //First order frequency evolution
-            if(NP>7) arg2 += M_PI*dfdt*xi[i]*xi[i];
-            
-            //Second order frequency evolution
-            if(NP>8) arg2 += (M_PI/3.0)*d2fdt2*xi[i]*xi[i]*xi[i];
-            
-            //Evolution of amplitude
-            double aevol = 1.0;
-            
-            //First order amplitude evolution
-            if(NP>7) aevol += 0.66666666666666666666*dfdt/f0*xi[i];
-            
-            //Second order amplitude evolution
-            //if(NP>8) aevol += const.*d2fdt2*xi[i]*xi[i]/f0;
-            
-            for(j=1; j<=3; j++)
+            if(i!=j)
             {
-                if(i!=j)
+                //Argument of transfer function
+                /*
+                 * Set to match LDC convention
+                 *
+                 https://gitlab.in2p3.fr/LISA/LDC/-/blob/develop/ldc/waveform/fastGB/GB.cc#L601
+                 */
+                double arg1 = 0.5*fonfs[i]*(1.0 + kdotr[i][j]);
+                
+                if(transfer_reference)
                 {
-                    //Argument of transfer function
-                    /*
-                     * Set to match LDC convention
-                     *
-                     https://gitlab.in2p3.fr/LISA/LDC/-/blob/develop/ldc/waveform/fastGB/GB.cc#L601
-                     */
-                    double arg1 = 0.5*fonfs[i]*(1.0 + kdotr[i][j]);
-                    
-                    //Transfer function
-                    double sinc = 0.25*sin(arg1)/arg1;
-                    
-                    //Real and imaginary pieces of time series (no complex exponential)
-                    double tran1r = aevol*(dplus[i][j]*DPr + dcross[i][j]*DCr);
-                    double tran1i = aevol*(dplus[i][j]*DPi + dcross[i][j]*DCi);
-                    
-                    //Real and imaginry components of complex exponential
-                    double tran2r = cos(arg1 + arg2);
-                    double tran2i = sin(arg1 + arg2);
-                    
-                    //Real & Imaginary part of the slowly evolving signal
-                    TR[i][j] = sinc*(tran1r*tran2r - tran1i*tran2i);
-                    TI[i][j] = sinc*(tran1r*tran2i + tran1i*tran2r);
+                    double sinc = 0.25*sin(arg1)/arg1*aevol;
+                    GR[i][j] = sinc*cos(arg1 + arg2);
+                    GI[i][j] = sinc*sin(arg1 + arg2);
+                    continue;
                 }
+                
+                double cos1, sin1;
+                transfer_sincos(arg1, &sin1, &cos1);
+                
+                //Transfer function and amplitude evolution
+                double sinc = 0.25*sin1/arg1*aevol;
+                
+                //Real and imaginry components of complex exponential exp(i(arg1+arg2))
+                GR[i][j] = sinc*(cos1*cos2 - sin1*sin2);
+                GI[i][j] = sinc*(sin1*cos2 + cos1*sin2);
             }
         }
-        
-        //Fill  time series data arrays with slowly evolving signal->
-        //dataij corresponds to fractional arm length difference yij
-        j = 2*n;
-        i = j-1;
-        data12[i] = TR[1][2];   data21[i] = TR[2][1];   data31[i] = TR[3][1];
-        data12[j] = TI[1][2];   data21[j] = TI[2][1];   data31[j] = TI[3][1];
-        data13[i] = TR[1][3];   data23[i] = TR[2][3];   data32[i] = TR[3][2];
-        data13[j] = TI[1][3];   data23[j] = TI[2][3];   data32[j] = TI[3][2];
     }
+}
+
+/* FFT the slowly evolving link responses in d and synthesize the TDI channels */
+static void template_tdi(struct Orbit *orbit, char *format, double T, struct GBTemplate *tmpl, double ***d, double *X, double *A, double *E, int BW, int NI)
+{
+    int i,j;
+    double invBW2 = 1./(double)(2*BW);
+    
+    double *data12 = d[1][2], *data13 = d[1][3], *data21 = d[2][1];
+    double *data23 = d[2][3], *data31 = d[3][1], *data32 = d[3][2];
     
     /*   Numerical Fourier transform of slowly evolving signal   */
-    gsl_fft_complex_radix2_forward (data12+1, 1, BW);
-    gsl_fft_complex_radix2_forward (data21+1, 1, BW);
-    gsl_fft_complex_radix2_forward (data31+1, 1, BW);
-    gsl_fft_complex_radix2_forward (data13+1, 1, BW);
-    gsl_fft_complex_radix2_forward (data23+1, 1, BW);
-    gsl_fft_complex_radix2_forward (data32+1, 1, BW);
-    
-    //Unpack arrays from fft and normalize
+    double *links[6] = {data12+1, data21+1, data31+1, data13+1, data23+1, data32+1};
+    complex_fft_forward(links, BW, 6);
+    
+    //Unpack arrays from fft and normalize (swap halves in place)
+    double swap;
     for(i=1; i<=BW; i++)
     {
         j = i + BW;
-        a12[i] = data12[j]*invBW2;  a21[i] = data21[j]*invBW2;  a31[i] = data31[j]*invBW2;
-        a12[j] = data12[i]*invBW2;  a21[j] = data21[i]*invBW2;  a31[j] = data31[i]*invBW2;
-        a13[i] = data13[j]*invBW2;  a23[i] = data23[j]*invBW2;  a32[i] = data32[j]*invBW2;
-        a13[j] = data13[i]*invBW2;  a23[j] = data23[i]*invBW2;  a32[j] = data32[i]*invBW2;
-    }
-    
-    /*   Renormalize so that the resulting time series is real   */
-    for(i=1; i<=BW2; i++)
-    {
-        d[1][2][i] = a12[i];  d[2][1][i] = a21[i];  d[3][1][i] = a31[i];
-        d[1][3][i] = a13[i];  d[2][3][i] = a23[i];  d[3][2][i] = a32[i];
+        swap = data12[i]; data12[i] = data12[j]*invBW2; data12[j] = swap*invBW2;
+        swap = data21[i]; data21[i] = data21[j]*invBW2; data21[j] = swap*invBW2;
+        swap = data31[i]; data31[i] = data31[j]*invBW2; data31[j] = swap*invBW2;
+        swap = data13[i]; data13[i] = data13[j]*invBW2; data13[j] = swap*invBW2;
+        swap = data23[i]; data23[i] = data23[j]*invBW2; data23[j] = swap*invBW2;
+        swap = data32[i]; data32[i] = data32[j]*invBW2; data32[j] = swap*invBW2;
     }
     
     /*   Call subroutines for synthesizing different TDI data channels  */
     if(strcmp("phase",format) == 0)
-        LISA_tdi(orbit->L, orbit->fstar, T, d, f0, q, X-1, A-1, E-1, BW, NI);
+        LISA_tdi(orbit->L, orbit->fstar, T, d, tmpl->f0, tmpl->q, X-1, A-1, E-1, BW, NI);
     else if(strcmp("frequency",format) == 0)
-        LISA_tdi_FF(orbit->L, orbit->fstar, T, d, f0, q, X-1, A-1, E-1, BW, NI);
+        LISA_tdi_FF(orbit->L, orbit->fstar, T, d, tmpl->f0, tmpl->q, X-1, A-1, E-1, BW, NI);
     else
     {
         fprintf(stderr,"Unsupported data format %s",format);
         exit(1);
     }
+}
+
+void galactic_binary_batch(struct Orbit *orbit, char *format, double T, double t0, double **params, int NP, int Nbatch, double **X, double **A, double **E, int BW, int NI)
+{
+    /*   Indicies   */
+    int i,j,n,b;
+    
+    /*   Convenient quantities   */
+    double dplus[4][4]={{0}},dcross[4][4]={{0}};
+    /*   Polarization-independent transfer function   */
+    double GR[4][4]={{0}}, GI[4][4]={{0}};
+    /*   LISA response to slow terms (Real & Imaginary pieces)   */
+    //Time varrying quantities (Re & Im) broken up into convenient segments
+    double TR[4][4]={{0}}, TI[4][4]={{0}};
+    
+    /*   Fourier coefficients before FFT and after convolution  */
+    //Time series of slowly evolving terms at each vertex for each template, transformed in place
+    struct GBWaveformWorkspace *workspace = get_waveform_workspace(BW, Nbatch);
     
-    /*   Free Arrays   */
-    free(x);
-    free(y);
-    free(z);
+    /*   Spacecraft ephemerides at each time sample, shared by all templates   */
+    struct OrbitCache *cache = get_orbit_cache(orbit, t0, T, BW);
     
-    free(data12);
-    free(data21);
-    free(data31);
-    free(data13);
-    free(data23);
-    free(data32);
+    /*   Gravitational Wave source parameters   */
+    for(b=0; b<Nbatch; b++) set_template_constants(&workspace->templates[b], params[b], NP, T);
     
-    for(i=0; i<4; i++)
+    /* Main loop over signal bandwidth */
+    for(n=1; n<=BW; n++)
     {
-        for(j=0; j<4; j++)
+        //First time sample must be at t=0 for phasing
+        double t = t0 + T*(double)(n-1)/(double)BW;
+        
+        for(b=0; b<Nbatch; b++)
         {
-            free(d[i][j]);
+            struct GBTemplate *tmpl = &workspace->templates[b];
+            
+            template_transfer(orbit, cache, tmpl, NP, n, t, dplus, dcross, GR, GI);
+            
+            for(i=1; i<=3; i++)
+            {
+                for(j=1; j<=3; j++)
+                {
+                    if(i!=j)
+                    {
+                        //Real and imaginary pieces of time series (no complex exponential)
+                        double tran1r = dplus[i][j]*tmpl->DPr + dcross[i][j]*tmpl->DCr;
+                        double tran1i = dplus[i][j]*tmpl->DPi + dcross[i][j]*tmpl->DCi;
+                        
+                        //Real & Imaginary part of the slowly evolving signal
+                        TR[i][j] = tran1r*GR[i][j] - tran1i*GI[i][j];
+                        TI[i][j] = tran1r*GI[i][j] + tran1i*GR[i][j];
+                    }
+                }
+            }
+            
+            //Fill  time series data arrays with slowly evolving signal->
+            //d[i][j] corresponds to fractional arm length difference yij
+            double ***d = workspace->d[b];
+            int re = 2*n-1;
+            int im = 2*n;
+            d[1][2][re] = TR[1][2];   d[2][1][re] = TR[2][1];   d[3][1][re] = TR[3][1];
+            d[1][2][im] = TI[1][2];   d[2][1][im] = TI[2][1];   d[3][1][im] = TI[3][1];
+            d[1][3][re] = TR[1][3];   d[2][3][re] = TR[2][3];   d[3][2][re] = TR[3][2];
+            d[1][3][im] = TI[1][3];   d[2][3][im] = TI[2][3];   d[3][2][im] = TI[3][2];
         }
-        free(d[i]);
     }
-    free(d);
     
+    for(b=0; b<Nbatch; b++)
+        template_tdi(orbit, format, T, &workspace->templates[b], workspace->d[b], X[b], A[b], E[b], BW, NI);
     
     return;
 }
+
+void galactic_binary_polarizations(struct Orbit *orbit, char *format, double T, double t0, double *params, int NP, double *Xp, double *Ap, double *Ep, double *Xc, double *Ac, double *Ec, int BW, int NI)
+{
+    int i,j,n;
+    
+    double dplus[4][4]={{0}},dcross[4][4]={{0}};
+    double GR[4][4]={{0}}, GI[4][4]={{0}};
+    
+    //two slots: d[0] holds the plus response, d[1] the cross response
+    struct GBWaveformWorkspace *workspace = get_waveform_workspace(BW, 2);
+    struct OrbitCache *cache = get_orbit_cache(orbit, t0, T, BW);
+    
+    //only f0, sky location, and frequency derivatives are used. phase is referenced to phi0=0
+    struct GBTemplate *tmpl = &workspace->templates[0];
+    set_template_constants(tmpl, params, NP, T);
+    tmpl->phi0 = 0.0;
+    
+    double ***dp = workspace->d[0];
+    double ***dc = workspace->d[1];
+    
+    for(n=1; n<=BW; n++)
+    {
+        double t = t0 + T*(double)(n-1)/(double)BW;
+        
+        template_transfer(orbit, cache, tmpl, NP, n, t, dplus, dcross, GR, GI);
+        
+        int re = 2*n-1;
+        int im = 2*n;
+        for(i=1; i<=3; i++)
+        {
+            for(j=1; j<=3; j++)
+            {
+                if(i!=j)
+                {
+                    dp[i][j][re] = dplus[i][j]*GR[i][j];
+                    dp[i][j][im] = dplus[i][j]*GI[i][j];
+                    dc[i][j][re] = dcross[i][j]*GR[i][j];
+                    dc[i][j][im] = dcross[i][j]*GI[i][j];
+                }
+            }
+        }
+    }
+    
+    template_tdi(orbit, format, T, tmpl, dp, Xp, Ap, Ep, BW, NI);
+    template_tdi(orbit, format, T, tmpl, dc, Xc, Ac, Ec, BW, NI);
+}
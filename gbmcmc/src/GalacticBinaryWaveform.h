@@ -68,9 +68,11 @@ double galactic_binary_dL(double f0, double dfdt, double A);
 /**
  \brief computes Fisher Information Matrix for UCB waveform parameters Source::params
  
- Computes matrix elements numerically using central differencing
+ Computes matrix elements
  \f$\Gamma_{ij} = \frac{\partial h}{\partial \theta_i} \frac{\partial h}{\partial \theta_j} \f$
- and stores in Source::fisher_matrix.
+ over the bandwidth of the source and stores in Source::fisher_matrix.
+ Derivatives with respect to amplitude, inclination, polarization, and phase are exact combinations of the
+ plus and cross responses from galactic_binary_polarizations().  The remaining parameters use central differencing.
  Matrix eigenvectors and eigenvalues are then computed using matrix_eigenstuff() and stored in Source::fisher_evectr and Source::fisher_evalue, respectively.
  
  @param[in] Source::params
@@ -80,6 +82,33 @@ double galactic_binary_dL(double f0, double dfdt, double A);
  */
 void galactic_binary_fisher(struct Orbit *orbit, struct Data *data, struct Source *source, struct Noise *noise);
 
+/**
+ \brief squared distance between `params` and Source::fisher_params measured by Source::fisher_matrix
+ 
+ @param[in] Source::fisher_evectr, Source::fisher_evalue, Source::fisher_params
+ @param[in] params location to measure
+ @param[out] d2 \f$\Delta^T \Gamma \Delta\f$
+ @return 1 if the Fisher matrix is usable, 0 if it was never computed or is not positive definite
+ */
+int galactic_binary_fisher_distance(struct Source *source, double *params, double *d2);
+
+/**
+ \brief checks if Source::fisher_matrix needs to be recomputed
+ 
+ The matrix is stale if Source::params has drifted from Source::fisher_params by
+ more than two standard deviations per parameter, measured with the Fisher matrix
+ itself and scaled by the chain `temperature`, or if the acceptance rate of
+ draw_from_fisher() since the last update has fallen below 5%.
+ Matrices that were never computed, or have eigenvalues that are not
+ positive and finite, are always stale.
+ 
+ @param[in] Source::params, Source::fisher_params
+ @param[in] Source::fisher_trial, Source::fisher_accept
+ @param[in] temperature chain temperature
+ @return 1 if galactic_binary_fisher() should be called, 0 otherwise
+ */
+int galactic_binary_fisher_stale(struct Source *source, double temperature);
+
 /**
  \brief aligns generated UCB waveform with Data array
  
@@ -109,6 +138,36 @@ void galactic_binary_alignment(struct Orbit *orbit, struct Data *data, struct So
  */
 int galactic_binary_bandwidth(double L, double fstar, double f, double fdot, double costheta, double A, double T, int N);
 
+/**
+ \brief Scratch space for galactic_binary()
+ 
+ Holds the slowly evolving time series of each link \f$ y_{ij} \f$
+ for every template in a batch, which are Fourier transformed and unpacked
+ in place.  Reused between calls so that waveform generation does not touch the heap.
+ */
+struct GBWaveformWorkspace
+{
+    int BWmax;    //!<largest bandwidth [bins] the workspace can hold
+    int Nmax;     //!<largest number of templates the workspace can hold
+    double ****d; //!<`d[b][i][j][1..2*BWmax]` interleaved time/frequency series for link \f$ ij \f$ of template `b`
+    struct GBTemplate *templates; //!<per-template constants used by galactic_binary_batch()
+};
+
+/**
+ \brief Allocates GBWaveformWorkspace for batches of up to Nmax templates, each up to BWmax bins wide
+ */
+void alloc_waveform_workspace(struct GBWaveformWorkspace *workspace, int BWmax, int Nmax);
+
+/**
+ \brief Frees GBWaveformWorkspace, including the structure itself
+ */
+void free_waveform_workspace(struct GBWaveformWorkspace *workspace);
+
+/**
+ \brief Returns the calling thread's GBWaveformWorkspace, reallocating it if BW or Nbatch exceed GBWaveformWorkspace::BWmax or GBWaveformWorkspace::Nmax
+ */
+struct GBWaveformWorkspace *get_waveform_workspace(int BW, int Nbatch);
+
 /**
  \brief Galactic binary waveform generator using fast-slow decomposition first described in <a href="https://journals.aps.org/prd/abstract/10.1103/PhysRevD.76.083006">Cornish and Littenberg, PRD 76, 083006</a>.
 
@@ -134,4 +193,58 @@ int galactic_binary_bandwidth(double L, double fstar, double f, double fdot, dou
  */
 void galactic_binary(struct Orbit *orbit, char *format, double T, double t0, double params[], int NP, double *X, double *A, double *E, int BW, int NI);
 
+/**
+ \brief Selects how galactic_binary() evaluates the transfer function phasor
+ 
+ By default \f$e^{i({\rm arg}_1+{\rm arg}_2)}\f$ is built by angle addition, with a
+ Taylor series for the small transfer phase \f${\rm arg}_1\f$.  The reference path
+ calls `sin` and `cos` directly for every link and is used by `gb_bench --check`
+ to verify the fast path.
+ 
+ @param[in] reference 1 for direct `sin`/`cos` calls, 0 for the fast path
+ */
+void galactic_binary_reference_transfer(int reference);
+
+/**
+ \brief Computes galactic_binary() for a batch of templates sharing the same bandwidth
+ 
+ The spacecraft positions and arm unit vectors depend only on the time samples, which are fixed by T, t0, and BW.
+ They are evaluated once per sample and shared by every template in the batch, so the cost of the orbit
+ interpolation is amortized over Nbatch waveforms.
+ 
+ @param[in] orbit LISA ephemerides
+ @param[in] format TDI format, "phase" or "frequency"
+ @param[in] T observation time \f$ T_{\rm obs}\ [{\rm s}]\f$
+ @param[in] t0 start time of observations \f$ t_0\ [{\rm s}]\f$
+ @param[in] params[b][] source parameters of template b
+ @param[in] NP number of source parameters (7, 8, or 9)
+ @param[in] Nbatch number of templates
+ @param[in] BW common source bandwidth [bins]
+ @param[in] NI number of interferometer channels (1 for X, 2 for A,E)
+ @param[out] X[b] single Michelson channel of template b
+ @param[out] A[b],E[b] noise orthogonal TDI channels of template b
+ */
+void galactic_binary_batch(struct Orbit *orbit, char *format, double T, double t0, double **params, int NP, int Nbatch, double **X, double **A, double **E, int BW, int NI);
+
+/**
+ \brief Unit-amplitude plus and cross polarization responses of a source
+ 
+ The LISA response is linear in the polarization amplitudes, so any waveform with the same
+ frequency evolution and sky location is a complex combination of these two basis responses.
+ Both share the orbit, arrival-time, and transfer-function evaluations.
+ The phase is referenced to \f$\varphi_0=0\f$; amplitude, inclination, polarization angle, and phase in `params` are ignored.
+ 
+ @param[in] orbit LISA ephemerides
+ @param[in] format TDI format, "phase" or "frequency"
+ @param[in] T observation time \f$ T_{\rm obs}\ [{\rm s}]\f$
+ @param[in] t0 start time of observations \f$ t_0\ [{\rm s}]\f$
+ @param[in] params source parameters
+ @param[in] NP number of source parameters (7, 8, or 9)
+ @param[in] BW source bandwidth [bins]
+ @param[in] NI number of interferometer channels (1 for X, 2 for A,E)
+ @param[out] Xp,Ap,Ep TDI response to \f$ h_+ = \cos\Phi \f$
+ @param[out] Xc,Ac,Ec TDI response to \f$ h_\times = \cos\Phi \f$
+ */
+void galactic_binary_polarizations(struct Orbit *orbit, char *format, double T, double t0, double *params, int NP, double *Xp, double *Ap, double *Ep, double *Xc, double *Ac, double *Ec, int BW, int NI);
+
 #endif /* GalacticBinaryWaveform_h */
@@ -0,0 +1,489 @@
+/*
+ *  Copyright (C) 2019 Tyson B. Littenberg (MSFC-ST12), Neil J. Cornish
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with with program; see the file COPYING. If not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ *  MA  02111-1307  USA
+ */
+
+/**
+ @file gb_bench.c
+ \brief Microbenchmarks of GBMCMC hot paths
+
+ Times the waveform, likelihood, and proposal kernels on canned inputs
+ with fixed random seeds and writes the results as JSON in the layout
+ used by Google Benchmark, so that runs can be compared across commits.
+
+ With `--check` it instead compares galactic_binary() against its reference
+ transfer function evaluation and exits with nonzero status if they disagree.
+
+ Usage: gb_bench [--min-time SEC] [--out FILE] [--check]
+ */
+
+/*  REQUIRED LIBRARIES  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+#include <omp.h>
+
+#include <LISA.h>
+
+#include "GalacticBinary.h"
+#include "GalacticBinaryData.h"
+#include "GalacticBinaryMath.h"
+#include "GalacticBinaryModel.h"
+#include "GalacticBinaryWaveform.h"
+#include "GalacticBinaryFStatistic.h"
+
+#include "gitversion.h"
+
+/* Number of sources in canned model */
+#define BENCH_NSOURCE 4
+
+/* Seed for canned noise realization */
+#define BENCH_SEED 150914
+
+/* Largest |fast - reference| allowed by --check, relative to peak of reference waveform */
+#define CHECK_TOLERANCE 1.0e-13
+
+/**
+ \brief Canned inputs shared by all benchmarks
+ */
+struct BenchContext
+{
+    struct Flags *flags;
+    struct Orbit *orbit;
+    struct Data *data;
+    struct Model *model;
+    struct Model *trial;
+
+    int BW;        //!<bandwidth of current waveform benchmark
+    double *params;//!<parameters of canned source
+    double *X;     //!<scratch waveform channels
+    double *A;
+    double *E;
+    double ***d;   //!<canned link responses for TDI benchmarks
+};
+
+/* canned UCB parameters, in the order expected by galactic_binary() */
+static void canned_params(struct Data *data, int n, double *params)
+{
+    double f0 = data->fmin + (double)(data->N/4 + n*data->N/(2*BENCH_NSOURCE))/data->T;
+
+    params[0] = f0*data->T;
+    params[1] = 0.3 - 0.2*n;
+    params[2] = 1.2 + 0.7*n;
+    params[3] = log(2.0e-22);
+    params[4] = 0.4;
+    params[5] = 0.7 + 0.3*n;
+    params[6] = 2.1;
+    params[7] = 1.0e-16*data->T*data->T;
+}
+
+static void setup_context(struct BenchContext *ctx)
+{
+    gsl_rng *r = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(r, BENCH_SEED);
+
+    struct Flags *flags = calloc(1,sizeof(struct Flags));
+    struct Orbit *orbit = calloc(1,sizeof(struct Orbit));
+    struct Data  *data  = calloc(1,sizeof(struct Data));
+
+    flags->NT    = 1;
+    flags->NMCMC = 100;
+    flags->DMAX  = 10;
+
+    sprintf(data->format,"phase");
+    data->t0       = calloc(1,sizeof(double));
+    data->tgap     = calloc(1,sizeof(double));
+    data->T        = 62914560.0;
+    data->sqT      = sqrt(data->T);
+    data->N        = 512;
+    data->NP       = 8;
+    data->Nchannel = 2;
+    data->DMAX     = flags->DMAX;
+    data->qpad     = 0;
+    data->fmin     = floor(4.0e-3*data->T)/data->T;
+    data->fmax     = data->fmin + data->N/data->T;
+    data->qmin     = (int)(data->fmin*data->T);
+    data->qmax     = data->qmin + data->N;
+
+    alloc_data(data, flags);
+    initialize_analytic_orbit(orbit);
+    GalacticBinaryGetNoiseModel(data, orbit, flags);
+
+    /* model of BENCH_NSOURCE sources */
+    struct Model *model = malloc(sizeof(struct Model));
+    struct Model *trial = malloc(sizeof(struct Model));
+    alloc_model(model, data->DMAX, data->N, data->Nchannel, data->NP, flags->NT);
+    alloc_model(trial, data->DMAX, data->N, data->Nchannel, data->NP, flags->NT);
+    model->Nlive = BENCH_NSOURCE;
+    for(int n=0; n<BENCH_NSOURCE; n++) canned_params(data, n, model->source[n]->params);
+    copy_noise(data->noise[0], model->noise[0]);
+    generate_noise_model(data, model);
+    generate_signal_model(orbit, data, model, -1);
+
+    /* data = signal + Gaussian noise */
+    for(int i=0; i<2*data->N; i++)
+    {
+        double SnA = data->noise[0]->SnA[i/2];
+        double SnE = data->noise[0]->SnE[i/2];
+        data->tdi[0]->A[i] = model->tdi[0]->A[i] + gsl_ran_gaussian(r, sqrt(SnA/2.));
+        data->tdi[0]->E[i] = model->tdi[0]->E[i] + gsl_ran_gaussian(r, sqrt(SnE/2.));
+    }
+    model->logL     = gaussian_log_likelihood(data, model);
+    model->logLnorm = gaussian_log_likelihood_constant_norm(data, model);
+    copy_model(model, trial);
+
+    /* scratch waveform and canned link responses */
+    int BWmax = 4096;
+    ctx->params = calloc(data->NP,sizeof(double));
+    canned_params(data, 0, ctx->params);
+    ctx->X = calloc(2*BWmax,sizeof(double));
+    ctx->A = calloc(2*BWmax,sizeof(double));
+    ctx->E = calloc(2*BWmax,sizeof(double));
+    ctx->d = malloc(4*sizeof(double **));
+    for(int i=0; i<4; i++)
+    {
+        ctx->d[i] = malloc(4*sizeof(double *));
+        for(int j=0; j<4; j++)
+        {
+            ctx->d[i][j] = calloc(2*BWmax+1,sizeof(double));
+            for(int k=1; k<=2*BWmax; k++) ctx->d[i][j][k] = gsl_ran_gaussian(r,1.0);
+        }
+    }
+
+    ctx->flags = flags;
+    ctx->orbit = orbit;
+    ctx->data  = data;
+    ctx->model = model;
+    ctx->trial = trial;
+
+    gsl_rng_free(r);
+}
+
+
+/* ============================  BENCHMARKS  ============================ */
+
+static void bench_galactic_binary(struct BenchContext *ctx)
+{
+    struct Data *data = ctx->data;
+    galactic_binary(ctx->orbit, data->format, data->T, data->t0[0], ctx->params, data->NP, ctx->X, ctx->A, ctx->E, ctx->BW, data->Nchannel);
+}
+
+static void bench_galactic_binary_reference(struct BenchContext *ctx)
+{
+    galactic_binary_reference_transfer(1);
+    bench_galactic_binary(ctx);
+    galactic_binary_reference_transfer(0);
+}
+
+static void bench_LISA_tdi(struct BenchContext *ctx)
+{
+    struct Orbit *orbit = ctx->orbit;
+    double f0 = ctx->params[0]/ctx->data->T;
+    LISA_tdi(orbit->L, orbit->fstar, ctx->data->T, ctx->d, f0, (long)ctx->params[0], ctx->X-1, ctx->A-1, ctx->E-1, ctx->BW, 2);
+}
+
+static void bench_LISA_tdi_FF(struct BenchContext *ctx)
+{
+    struct Orbit *orbit = ctx->orbit;
+    double f0 = ctx->params[0]/ctx->data->T;
+    LISA_tdi_FF(orbit->L, orbit->fstar, ctx->data->T, ctx->d, f0, (long)ctx->params[0], ctx->X-1, ctx->A-1, ctx->E-1, ctx->BW, 2);
+}
+
+static void bench_generate_signal_model(struct BenchContext *ctx)
+{
+    generate_signal_model(ctx->orbit, ctx->data, ctx->trial, -1);
+}
+
+static void bench_gaussian_log_likelihood(struct BenchContext *ctx)
+{
+    ctx->trial->logL = gaussian_log_likelihood(ctx->data, ctx->trial);
+}
+
+/* residual followed by separate fourier_nwip() passes, for comparison with gaussian_log_likelihood() */
+static void bench_gaussian_log_likelihood_reference(struct BenchContext *ctx)
+{
+    struct Data *data = ctx->data;
+    struct Model *model = ctx->trial;
+    struct TDI *residual = model->residual[0];
+
+    for(int i=0; i<2*data->N; i++)
+    {
+        residual->X[i] = data->tdi[0]->X[i] - model->tdi[0]->X[i];
+        residual->A[i] = data->tdi[0]->A[i] - model->tdi[0]->A[i];
+        residual->E[i] = data->tdi[0]->E[i] - model->tdi[0]->E[i];
+    }
+    model->logL  = -0.5*fourier_nwip(residual->A, residual->A, model->noise[0]->SnA, data->N);
+    model->logL += -0.5*fourier_nwip(residual->E, residual->E, model->noise[0]->SnE, data->N);
+}
+
+static void bench_copy_model(struct BenchContext *ctx)
+{
+    copy_model(ctx->model, ctx->trial);
+}
+
+static void bench_galactic_binary_fisher(struct BenchContext *ctx)
+{
+    galactic_binary_fisher(ctx->orbit, ctx->data, ctx->trial->source[0], ctx->data->noise[0]);
+}
+
+static void bench_get_Fstat_logL(struct BenchContext *ctx)
+{
+    double logL_X, logL_AE, Fparams[4];
+    struct Source *source = ctx->model->source[0];
+    get_Fstat_logL(ctx->orbit, ctx->data, source->f0, source->dfdt, acos(source->costheta), source->phi, &logL_X, &logL_AE, Fparams);
+}
+
+static void bench_waveform_match(struct BenchContext *ctx)
+{
+    waveform_match(ctx->model->source[0], ctx->model->source[1], ctx->data->noise[0]);
+}
+
+
+/* ============================  CHECKS  ============================ */
+
+/* largest |a-b| relative to the largest |b| */
+static double max_relative_difference(double *a, double *b, int n)
+{
+    double dmax = 0.0;
+    double bmax = 0.0;
+    for(int i=0; i<n; i++)
+    {
+        if(fabs(a[i]-b[i]) > dmax) dmax = fabs(a[i]-b[i]);
+        if(fabs(b[i]) > bmax) bmax = fabs(b[i]);
+    }
+    return (bmax > 0.0) ? dmax/bmax : dmax;
+}
+
+/*
+ Compare galactic_binary() with the fast transfer function against the
+ reference sin/cos evaluation over a range of f0 and BW, in both TDI formats.
+ Returns the number of cases exceeding CHECK_TOLERANCE.
+ */
+static int check_galactic_binary_transfer(struct BenchContext *ctx)
+{
+    struct Data *data = ctx->data;
+    int NP = data->NP;
+    int BWmax = 1024;
+    int failed = 0;
+    double worst = 0.0;
+    char format[2][16] = {"phase","frequency"};
+    
+    double *params = calloc(NP,sizeof(double));
+    double *X = calloc(2*BWmax,sizeof(double));
+    double *A = calloc(2*BWmax,sizeof(double));
+    double *E = calloc(2*BWmax,sizeof(double));
+    double *Xref = calloc(2*BWmax,sizeof(double));
+    double *Aref = calloc(2*BWmax,sizeof(double));
+    double *Eref = calloc(2*BWmax,sizeof(double));
+    
+    for(int k=0; k<2; k++)
+    {
+        for(double f0=1.0e-4; f0<3.0e-2; f0*=1.5)
+        {
+            for(int BW=32; BW<=BWmax; BW*=2)
+            {
+                canned_params(data, 0, params);
+                params[0] = f0*data->T;
+                
+                galactic_binary_reference_transfer(1);
+                galactic_binary(ctx->orbit, format[k], data->T, data->t0[0], params, NP, Xref, Aref, Eref, BW, data->Nchannel);
+                galactic_binary_reference_transfer(0);
+                galactic_binary(ctx->orbit, format[k], data->T, data->t0[0], params, NP, X, A, E, BW, data->Nchannel);
+                
+                double err = max_relative_difference(A, Aref, 2*BW);
+                double errE = max_relative_difference(E, Eref, 2*BW);
+                if(errE > err) err = errE;
+                if(err > worst) worst = err;
+                
+                if(err > CHECK_TOLERANCE)
+                {
+                    fprintf(stderr,"FAIL: galactic_binary %s f0=%g BW=%i: relative difference %g\n",format[k],f0,BW,err);
+                    failed++;
+                }
+            }
+        }
+    }
+    fprintf(stderr,"galactic_binary transfer check: worst relative difference %g (tolerance %g), %i failed\n",worst,CHECK_TOLERANCE,failed);
+    
+    free(params);
+    free(X);
+    free(A);
+    free(E);
+    free(Xref);
+    free(Aref);
+    free(Eref);
+    
+    return failed;
+}
+
+
+/* ============================  HARNESS  ============================ */
+
+/*
+ Repeat fn, doubling the iteration count until a batch takes at least
+ min_time seconds, and report the mean wall time per iteration.
+ */
+static void run_benchmark(FILE *fptr, int *first, const char *name, void (*fn)(struct BenchContext *), struct BenchContext *ctx, double min_time)
+{
+    long iterations = 1;
+    double elapsed  = 0.0;
+
+    fn(ctx); //warm up caches and per-thread workspaces
+
+    while(1)
+    {
+        double start = omp_get_wtime();
+        for(long i=0; i<iterations; i++) fn(ctx);
+        elapsed = omp_get_wtime() - start;
+
+        if(elapsed >= min_time || iterations >= (1L<<30)) break;
+
+        double scale = (elapsed > 0.0) ? 1.4*min_time/elapsed : 10.0;
+        if(scale < 2.0)  scale = 2.0;
+        if(scale > 10.0) scale = 10.0;
+        iterations = (long)(iterations*scale);
+    }
+
+    double ns = 1.0e9*elapsed/(double)iterations;
+
+    fprintf(fptr,"%s    {\n",(*first) ? "" : ",\n");
+    fprintf(fptr,"      \"name\": \"%s\",\n",name);
+    fprintf(fptr,"      \"iterations\": %li,\n",iterations);
+    fprintf(fptr,"      \"real_time\": %.6e,\n",ns);
+    fprintf(fptr,"      \"time_unit\": \"ns\"\n");
+    fprintf(fptr,"    }");
+    fflush(fptr);
+    *first = 0;
+
+    fprintf(stderr,"%-40s %14.1f ns %12li\n",name,ns,iterations);
+}
+
+static void print_bench_usage(void)
+{
+    fprintf(stdout,"\n");
+    fprintf(stdout,"Usage: gb_bench [options]\n");
+    fprintf(stdout,"       --min-time : minimum time per benchmark [s] (0.5)  \n");
+    fprintf(stdout,"       --out      : JSON output file (stdout)             \n");
+    fprintf(stdout,"       --check    : check fast paths against reference    \n");
+    fprintf(stdout,"\n");
+    exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+    double min_time = 0.5;
+    int check = 0;
+    char outFile[MAXSTRINGSIZE] = "";
+
+    static struct option long_options[] =
+    {
+        {"min-time", required_argument, 0, 0},
+        {"out",      required_argument, 0, 0},
+        {"check",    no_argument,       0, 0},
+        {"help",     no_argument,       0,'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt=0;
+    int long_index=0;
+    while ((opt = getopt_long_only(argc, argv,"h", long_options, &long_index )) != -1)
+    {
+        switch (opt)
+        {
+            case 0:
+                if(strcmp("min-time", long_options[long_index].name) == 0) min_time = atof(optarg);
+                if(strcmp("out",      long_options[long_index].name) == 0) strcpy(outFile,optarg);
+                if(strcmp("check",    long_options[long_index].name) == 0) check = 1;
+                break;
+            case 'h':
+            default:
+                print_bench_usage();
+                break;
+        }
+    }
+
+    if(check)
+    {
+        struct BenchContext *ctx = malloc(sizeof(struct BenchContext));
+        setup_context(ctx);
+        return (check_galactic_binary_transfer(ctx) > 0) ? 1 : 0;
+    }
+
+    FILE *fptr = stdout;
+    if(strlen(outFile)>0 && (fptr = fopen(outFile,"w")) == NULL)
+    {
+        fprintf(stderr,"Could not open %s for writing\n",outFile);
+        exit(1);
+    }
+
+    struct BenchContext *ctx = malloc(sizeof(struct BenchContext));
+    setup_context(ctx);
+
+    char date[64];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(fptr,"{\n");
+    fprintf(fptr,"  \"context\": {\n");
+    fprintf(fptr,"    \"date\": \"%s\",\n",date);
+    fprintf(fptr,"    \"executable\": \"%s\",\n",argv[0]);
+    fprintf(fptr,"    \"git_version\": \"%s\",\n",GITVERSION);
+    fprintf(fptr,"    \"num_threads\": 1,\n");
+    fprintf(fptr,"    \"seed\": %i,\n",BENCH_SEED);
+    fprintf(fptr,"    \"samples\": %i,\n",ctx->data->N);
+    fprintf(fptr,"    \"sources\": %i\n",BENCH_NSOURCE);
+    fprintf(fptr,"  },\n");
+    fprintf(fptr,"  \"benchmarks\": [\n");
+
+    char name[MAXSTRINGSIZE];
+    int first = 1;
+
+    for(ctx->BW=32; ctx->BW<=4096; ctx->BW*=2)
+    {
+        sprintf(name,"galactic_binary/BW:%i",ctx->BW);
+        run_benchmark(fptr, &first, name, bench_galactic_binary, ctx, min_time);
+        sprintf(name,"galactic_binary_reference/BW:%i",ctx->BW);
+        run_benchmark(fptr, &first, name, bench_galactic_binary_reference, ctx, min_time);
+    }
+    for(ctx->BW=32; ctx->BW<=4096; ctx->BW*=4)
+    {
+        sprintf(name,"LISA_tdi/BW:%i",ctx->BW);
+        run_benchmark(fptr, &first, name, bench_LISA_tdi, ctx, min_time);
+        sprintf(name,"LISA_tdi_FF/BW:%i",ctx->BW);
+        run_benchmark(fptr, &first, name, bench_LISA_tdi_FF, ctx, min_time);
+    }
+    run_benchmark(fptr, &first, "generate_signal_model", bench_generate_signal_model, ctx, min_time);
+    run_benchmark(fptr, &first, "gaussian_log_likelihood", bench_gaussian_log_likelihood, ctx, min_time);
+    run_benchmark(fptr, &first, "gaussian_log_likelihood_reference", bench_gaussian_log_likelihood_reference, ctx, min_time);
+    run_benchmark(fptr, &first, "copy_model", bench_copy_model, ctx, min_time);
+    run_benchmark(fptr, &first, "galactic_binary_fisher", bench_galactic_binary_fisher, ctx, min_time);
+    run_benchmark(fptr, &first, "get_Fstat_logL", bench_get_Fstat_logL, ctx, min_time);
+    run_benchmark(fptr, &first, "waveform_match", bench_waveform_match, ctx, min_time);
+
+    fprintf(fptr,"\n  ]\n}\n");
+    if(fptr != stdout) fclose(fptr);
+
+    return 0;
+}
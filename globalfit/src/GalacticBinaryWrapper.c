@@ -7,6 +7,7 @@
 
 #include <mpi.h>
 #include <omp.h>
+#include <math.h>
 #include <string.h>
 
 #include <stdio.h>
@@ -16,6 +17,7 @@
 #include <GalacticBinary.h>
 #include <GalacticBinaryIO.h>
 #include <GalacticBinaryData.h>
+#include <GalacticBinaryMath.h>
 #include <GalacticBinaryPrior.h>
 #include <GalacticBinaryModel.h>
 #include <GalacticBinaryProposal.h>
@@ -32,6 +34,7 @@ void alloc_gbmcmc_data(struct GBMCMCData *gbmcmc_data, int procID, int procID_mi
     gbmcmc_data->procID = procID;
     gbmcmc_data->procID_min = procID_min;
     gbmcmc_data->procID_max = procID_max;
+    MPI_Comm_split(MPI_COMM_WORLD, (procID>=procID_min && procID<=procID_max) ? 0 : MPI_UNDEFINED, procID, &gbmcmc_data->comm);
     gbmcmc_data->flags = malloc(sizeof(struct Flags));
     gbmcmc_data->orbit = malloc(sizeof(struct Orbit));
     gbmcmc_data->chain = malloc(sizeof(struct Chain));
@@ -39,13 +42,25 @@ void alloc_gbmcmc_data(struct GBMCMCData *gbmcmc_data, int procID, int procID_mi
     gbmcmc_data->prior = malloc(sizeof(struct Prior));
 }
 
-void select_frequency_segment(struct Data *data, struct TDI *tdi_full, int procID)
+/* first frequency bin of a segment, shared by every rank so root and workers agree */
+static int frequency_segment_qmin(struct Data *data, int segment)
+{
+    double fmin = data->fmin + (double)(segment*(data->N - 2*data->qpad))/data->T;
+    return (int)(fmin*data->T);
+}
+
+static void set_frequency_segment(struct Data *data, int procID)
 {
     //get max and min samples
     data->fmin = data->fmin + (double)(procID*(data->N - 2*data->qpad))/data->T;
     data->fmax = data->fmin + data->N/data->T;
     data->qmin = (int)(data->fmin*data->T);
     data->qmax = data->qmin+data->N;
+}
+
+void select_frequency_segment(struct Data *data, struct TDI *tdi_full, int procID)
+{
+    set_frequency_segment(data, procID);
     
     //store frequency segment in TDI structure
     struct TDI *tdi = data->tdi[0];
@@ -74,25 +89,318 @@ void select_frequency_segment(struct Data *data, struct TDI *tdi_full, int procI
 
 void get_frequency_segment(struct Data *data, struct TDI *tdi_full, int Nsamples, int root, int procID)
 {
+    int Nproc;
+    MPI_Comm_size(MPI_COMM_WORLD, &Nproc);
+    
     //first tell all processes how large the dataset is
     MPI_Bcast(&Nsamples, 1, MPI_INT, root, MPI_COMM_WORLD);
     //MPI_Bcast(&data->T, 1, MPI_DOUBLE, root, MPI_COMM_WORLD); //only needed if read data maps to 2^N
     //MPI_Bcast(&data->sqT, 1, MPI_DOUBLE, root, MPI_COMM_WORLD);
+    
+    /*
+     Only the channels the sampler uses are distributed,
+     A&E for two channel analyses, everything otherwise
+     */
+    int Nsend = (data->Nchannel==2) ? 2 : 6;
+    
+    /*
+     Each gbmcmc process receives its own padded segment, 2*data->N doubles per
+     channel, instead of the whole mission. Neighboring segments overlap by the
+     padding so root uses point-to-point sends rather than MPI_Scatterv, which
+     may not read any location of the send buffer twice.
+     */
+    if(procID==root)
+    {
+        double *channel[6] = {tdi_full->A, tdi_full->E, tdi_full->X, tdi_full->Y, tdi_full->Z, tdi_full->T};
+        
+        MPI_Request *request = malloc(Nproc*Nsend*sizeof(MPI_Request));
+        int Nrequest = 0;
+        for(int n=0; n<Nproc; n++)
+        {
+            if(n==root) continue;
+            
+            int qmin = frequency_segment_qmin(data, n-1);
+            if(qmin < 0 || qmin + data->N > Nsamples)
+            {
+                fprintf(stderr,"Error: frequency segment for process %i [%i,%i) is outside of data [0,%i)\n",n,qmin,qmin+data->N,Nsamples);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            
+            for(int k=0; k<Nsend; k++)
+                MPI_Isend(channel[k]+2*qmin, 2*data->N, MPI_DOUBLE, n, k, MPI_COMM_WORLD, &request[Nrequest++]);
+        }
+        MPI_Waitall(Nrequest, request, MPI_STATUSES_IGNORE);
+        free(request);
+        
+        /* root hosts the noise model and keeps the full dataset, only the segment bounds are needed */
+        set_frequency_segment(data, procID-1);
+    }
+    else
+    {
+        /* select frequency segment for each process */
+        set_frequency_segment(data, procID-1);
+        
+        struct TDI *tdi = data->tdi[0];
+        struct TDI *raw = data->raw[0];
+        double *channel[6] = {tdi->A, tdi->E, tdi->X, tdi->Y, tdi->Z, tdi->T};
+        double *copy[6]    = {raw->A, raw->E, raw->X, raw->Y, raw->Z, raw->T};
+        
+        MPI_Request request[6];
+        for(int k=0; k<Nsend; k++)
+            MPI_Irecv(channel[k], 2*data->N, MPI_DOUBLE, root, k, MPI_COMM_WORLD, &request[k]);
+        MPI_Waitall(Nsend, request, MPI_STATUSES_IGNORE);
+        
+        /* raw data to be used as reference */
+        for(int k=0; k<Nsend; k++) memcpy(copy[k], channel[k], 2*data->N*sizeof(double));
+    }
+}
+
+/*
+ Distributed Fourier transform of the data segment (four-step FFT).
+ The NFFT = P*M samples are split into P contiguous time slices, one per
+ ingest process. Writing n = r*M + m and k = k1 + P*k2,
+ 
+ x(k) = sum_m w_N^(m k1) w_M^(m k2) sum_r x(r*M+m) w_P^(r k1)
+ 
+ so after one transpose each process does length P transforms over r for
+ its M/P values of m, and after a second transpose a length M transform
+ over m for its value of k1.  Process k1 then holds bins k1 + P*k2.
+ */
+static void distributed_fft(double *slice, double *spectrum, int NFFT, int P, int rank, MPI_Comm comm)
+{
+    int M = NFFT/P;
+    int C = M/P;
+    
+    double *column = malloc(2*P*sizeof(double));
+    double *buffer = malloc(2*M*sizeof(double));
+    
+    //process rank gets samples m = [rank*C,(rank+1)*C) of every slice
+    MPI_Alltoall(slice, C, MPI_DOUBLE, buffer, C, MPI_DOUBLE, comm);
+    
+    for(int mm=0; mm<C; mm++)
+    {
+        for(int r=0; r<P; r++)
+        {
+            column[2*r]   = buffer[r*C+mm];
+            column[2*r+1] = 0.0;
+        }
+        complex_fft_forward(&column, P, 1);
+        
+        //twiddle factors w_N^(m k1), sorted by destination k1
+        long m = (long)rank*C + mm;
+        for(int k1=0; k1<P; k1++)
+        {
+            double phase = -2.0*M_PI*(double)((m*k1)%NFFT)/(double)NFFT;
+            double c = cos(phase);
+            double s = sin(phase);
+            double re = column[2*k1];
+            double im = column[2*k1+1];
+            spectrum[2*(k1*C+mm)]   = re*c - im*s;
+            spectrum[2*(k1*C+mm)+1] = re*s + im*c;
+        }
+    }
+    
+    //process rank gets every m for k1 = rank, in order of m
+    MPI_Alltoall(spectrum, 2*C, MPI_DOUBLE, buffer, 2*C, MPI_DOUBLE, comm);
+    
+    complex_fft_forward(&buffer, M, 1);
+    memcpy(spectrum, buffer, 2*M*sizeof(double));
+    
+    free(column);
+    free(buffer);
+}
+
+/* frequency bins [qmin,qmax) each process needs from the distributed transform */
+static void frequency_segment_bins(struct Data *data, int NFFT, int Nproc, int root, int n, int *qmin, int *qmax)
+{
+    if(n==root)
+    {
+        //noise model segment spans every gbmcmc segment, give a bin either side for rounding
+        int Nseg = Nproc-1;
+        *qmin = frequency_segment_qmin(data, 0) - 1;
+        *qmax = *qmin + Nseg*(data->N - 2*data->qpad) + 2*data->qpad + 2;
+        if(*qmin < 0) *qmin = 0;
+        if(*qmax > NFFT/2) *qmax = NFFT/2;
+    }
+    else
+    {
+        *qmin = frequency_segment_qmin(data, n-1);
+        *qmax = *qmin + data->N;
+    }
+}
 
-    //all but root process need to allocate memory for TDI structure
-    if(procID!=root) alloc_tdi(tdi_full, Nsamples, N_TDI_CHANNELS);
+int get_frequency_segment_parallel(struct Data *data, struct TDI *tdi_full, int root, int procID)
+{
+    int Nproc;
+    MPI_Comm_size(MPI_COMM_WORLD, &Nproc);
+    
+    //sample cadence of the data
+    double dt;
+    if(procID==root)
+    {
+        struct TDI *head = malloc(sizeof(struct TDI));
+        LISA_Read_HDF5_LDC_TDI_Hyperslab(head, data->fileName, 0, 2);
+        dt = head->delta;
+        free_tdi(head);
+    }
+    MPI_Bcast(&dt, 1, MPI_DOUBLE, root, MPI_COMM_WORLD);
+    
+    //same segment length as GalacticBinaryReadHDF5()
+    double Tobs = (data->t0[0] + data->T) - data->t0[0];
+    int NFFT = (int)floor(Tobs/dt);
+    
+    //transforms are radix 2, so fall back to the serial ingest otherwise
+    if(NFFT < 4 || (NFFT & (NFFT-1))) return 0;
+    
+    //largest power of two number of ingest processes with P^2 <= NFFT
+    int P = 1;
+    while(2*P <= Nproc && 4*P*P <= NFFT) P *= 2;
+    int M = NFFT/P;
+    
+    for(int n=0; n<Nproc; n++)
+    {
+        int qmin, qmax;
+        frequency_segment_bins(data, NFFT, Nproc, root, n, &qmin, &qmax);
+        if(qmin < 0 || qmax > NFFT/2)
+        {
+            fprintf(stderr,"Error: frequency segment for process %i [%i,%i) is outside of data [0,%i)\n",n,qmin,qmax,NFFT/2);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    
+    /*
+     Only the channels the sampler uses are transformed,
+     A&E for two channel analyses, everything otherwise
+     */
+    int Nsend = (data->Nchannel==2) ? 2 : 6;
+    
+    //ingest processes are ranks [0,P)
+    MPI_Comm ingest;
+    MPI_Comm_split(MPI_COMM_WORLD, (procID<P) ? 0 : MPI_UNDEFINED, procID, &ingest);
+    
+    double **spectrum = malloc(Nsend*sizeof(double *));
+    if(procID<P)
+    {
+        struct TDI *slice = malloc(sizeof(struct TDI));
+        GalacticBinaryReadHDF5Slice(data, slice, dt, procID, P);
+        
+        double *channel[6] = {slice->A, slice->E, slice->X, slice->Y, slice->Z, slice->T};
+        for(int k=0; k<Nsend; k++)
+        {
+            spectrum[k] = malloc(2*M*sizeof(double));
+            distributed_fft(channel[k], spectrum[k], NFFT, P, procID, ingest);
+        }
+        
+        free_tdi(slice);
+        MPI_Comm_free(&ingest);
+    }
+    
+    /*
+     Redistribute so every process holds its contiguous frequency segment.
+     Ingest process s owns bins q = s mod P, stored at q/P, and sends them in
+     increasing q with the channels interleaved.
+     */
+    int *sendcounts = calloc(Nproc, sizeof(int));
+    int *recvcounts = calloc(Nproc, sizeof(int));
+    int *sdispls = calloc(Nproc, sizeof(int));
+    int *rdispls = calloc(Nproc, sizeof(int));
+    
+    int qmin, qmax;
+    frequency_segment_bins(data, NFFT, Nproc, root, procID, &qmin, &qmax);
+    
+    for(int n=0; n<Nproc; n++)
+    {
+        int lo, hi;
+        frequency_segment_bins(data, NFFT, Nproc, root, n, &lo, &hi);
+        
+        //bins of process n's segment owned by this process
+        if(procID<P)
+            for(int q=lo; q<hi; q++) if(q%P==procID) sendcounts[n] += 2*Nsend;
+        
+        //bins of this process's segment owned by process n
+        if(n<P)
+            for(int q=qmin; q<qmax; q++) if(q%P==n) recvcounts[n] += 2*Nsend;
+    }
+    for(int n=1; n<Nproc; n++)
+    {
+        sdispls[n] = sdispls[n-1] + sendcounts[n-1];
+        rdispls[n] = rdispls[n-1] + recvcounts[n-1];
+    }
     
-    //now broadcast contents of TDI structure
-    MPI_Bcast(&tdi_full->delta, 1, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->X, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->Y, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->Z, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->A, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->E, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
-    MPI_Bcast(tdi_full->T, 2*Nsamples, MPI_DOUBLE, root, MPI_COMM_WORLD);
+    double *send = malloc((sdispls[Nproc-1]+sendcounts[Nproc-1]+1)*sizeof(double));
+    double *recv = malloc((rdispls[Nproc-1]+recvcounts[Nproc-1]+1)*sizeof(double));
+    
+    if(procID<P)
+    {
+        int i = 0;
+        for(int n=0; n<Nproc; n++)
+        {
+            int lo, hi;
+            frequency_segment_bins(data, NFFT, Nproc, root, n, &lo, &hi);
+            for(int q=lo + ((procID - lo%P) + P)%P; q<hi; q+=P)
+            {
+                for(int k=0; k<Nsend; k++)
+                {
+                    send[i++] = spectrum[k][2*(q/P)];
+                    send[i++] = (q==0) ? 0.0 : spectrum[k][2*(q/P)+1]; //DC is real
+                }
+            }
+        }
+        for(int k=0; k<Nsend; k++) free(spectrum[k]);
+    }
+    free(spectrum);
+    
+    MPI_Alltoallv(send, sendcounts, sdispls, MPI_DOUBLE, recv, recvcounts, rdispls, MPI_DOUBLE, MPI_COMM_WORLD);
+    
+    /* unpack into the full frequency series on root, segment on gbmcmc processes */
+    struct TDI *tdi;
+    int offset;
+    if(procID==root)
+    {
+        alloc_tdi(tdi_full, NFFT/2, N_TDI_CHANNELS);
+        tdi_full->delta = 1./Tobs;
+        tdi = tdi_full;
+        offset = 0;
+    }
+    else
+    {
+        tdi = data->tdi[0];
+        offset = qmin;
+    }
+    double *channel[6] = {tdi->A, tdi->E, tdi->X, tdi->Y, tdi->Z, tdi->T};
+    
+    for(int n=0; n<P; n++)
+    {
+        int i = rdispls[n];
+        for(int q=qmin + ((n - qmin%P) + P)%P; q<qmax; q+=P)
+        {
+            for(int k=0; k<Nsend; k++)
+            {
+                channel[k][2*(q-offset)]   = recv[i++];
+                channel[k][2*(q-offset)+1] = recv[i++];
+            }
+        }
+    }
     
     /* select frequency segment for each process */
-    select_frequency_segment(data, tdi_full, procID-1);
+    set_frequency_segment(data, procID-1);
+    
+    /* raw data to be used as reference */
+    if(procID!=root)
+    {
+        struct TDI *raw = data->raw[0];
+        double *copy[6] = {raw->A, raw->E, raw->X, raw->Y, raw->Z, raw->T};
+        for(int k=0; k<Nsend; k++) memcpy(copy[k], channel[k], 2*data->N*sizeof(double));
+    }
+    
+    free(sendcounts);
+    free(recvcounts);
+    free(sdispls);
+    free(rdispls);
+    free(send);
+    free(recv);
+    
+    return 1;
 }
 
 void broadcast_cache(struct Data *data, int root, int procID)
@@ -115,6 +423,178 @@ void broadcast_cache(struct Data *data, int root, int procID)
 
 }
 
+#define EXCHANGE_TAG 1 /* MPI tag for parameter exchange */
+
+static int gbmcmc_neighbor(struct GBMCMCData *gbmcmc_data, int side)
+{
+    int neighbor = (side==0) ? gbmcmc_data->procID-1 : gbmcmc_data->procID+1;
+    if(neighbor < gbmcmc_data->procID_min || neighbor > gbmcmc_data->procID_max) return -1;
+    return neighbor;
+}
+
+static void setup_gbmcmc_exchange(struct GBMCMCData *gbmcmc_data)
+{
+    //every neighbor shares at most the maximum number of sources
+    gbmcmc_data->Nshare_max = gbmcmc_data->flags->DMAX*gbmcmc_data->data->NP;
+    gbmcmc_data->share_params = malloc(gbmcmc_data->Nshare_max*sizeof(double));
+    
+    for(int side=0; side<2; side++)
+    {
+        gbmcmc_data->recv_params[side] = malloc(gbmcmc_data->Nshare_max*sizeof(double));
+        gbmcmc_data->neighbor_params[side] = malloc(gbmcmc_data->Nshare_max*sizeof(double));
+        gbmcmc_data->Nneighbor_params[side] = 0;
+        gbmcmc_data->send_request[side] = MPI_REQUEST_NULL;
+        gbmcmc_data->recv_request[side] = MPI_REQUEST_NULL;
+        
+        int neighbor = gbmcmc_neighbor(gbmcmc_data, side);
+        if(neighbor>=0)
+            MPI_Irecv(gbmcmc_data->recv_params[side], gbmcmc_data->Nshare_max, MPI_DOUBLE, neighbor, EXCHANGE_TAG, MPI_COMM_WORLD, &gbmcmc_data->recv_request[side]);
+    }
+    
+    //waveforms of sources received from both neighbors
+    struct Data *data = gbmcmc_data->data;
+    struct Flags *flags = gbmcmc_data->flags;
+    gbmcmc_data->neighbor_model = malloc(sizeof(struct Model));
+    alloc_model(gbmcmc_data->neighbor_model, 2*flags->DMAX, data->N, data->Nchannel, data->NP, flags->NT);
+    gbmcmc_data->neighbor_model->Nlive = 0;
+    gbmcmc_data->logL_stale = 1;
+}
+
+/* add sign*waveform of source to tdi, growing the range of changed bins [imin,imax) */
+static void add_neighbor_waveform(struct Data *data, struct Source *source, struct TDI *tdi, double sign, int *imin, int *imax)
+{
+    for(int i=0; i<source->BW; i++)
+    {
+        int j = i+source->imin;
+        
+        if(j>-1 && j<data->N)
+        {
+            tdi->X[2*j]   += sign*source->tdi->X[2*i];
+            tdi->X[2*j+1] += sign*source->tdi->X[2*i+1];
+            
+            tdi->A[2*j]   += sign*source->tdi->A[2*i];
+            tdi->A[2*j+1] += sign*source->tdi->A[2*i+1];
+            
+            tdi->E[2*j]   += sign*source->tdi->E[2*i];
+            tdi->E[2*j+1] += sign*source->tdi->E[2*i+1];
+            
+            if(j < *imin) *imin = j;
+            if(j+1 > *imax) *imax = j+1;
+        }
+    }
+}
+
+/*
+ Replace cached neighbor sources with the newest ones received. Sources with
+ unchanged parameters keep their waveform, the rest are removed or generated.
+ The change in the sum of neighbor waveforms is left in neighbor_model->tdi
+ over bins [imin,imax).
+ */
+static void update_neighbor_sources(struct GBMCMCData *gbmcmc_data, int *imin, int *imax)
+{
+    struct Orbit *orbit = gbmcmc_data->orbit;
+    struct Data  *data  = gbmcmc_data->data;
+    struct Model *cache = gbmcmc_data->neighbor_model;
+    struct TDI *delta = cache->tdi[FIXME];
+    int NP = data->NP;
+    
+    int Nold = cache->Nlive;
+    int Nnew = (gbmcmc_data->Nneighbor_params[0] + gbmcmc_data->Nneighbor_params[1])/NP;
+    
+    //received parameters, left then right neighbor
+    double *params[Nnew+1];
+    for(int n=0; n<Nnew; n++)
+    {
+        int Nleft = gbmcmc_data->Nneighbor_params[0]/NP;
+        params[n] = (n<Nleft) ? gbmcmc_data->neighbor_params[0]+n*NP : gbmcmc_data->neighbor_params[1]+(n-Nleft)*NP;
+    }
+    
+    //match received sources to cached sources with identical parameters
+    int keep[Nold+1];
+    struct Source *slot[Nnew+1];
+    for(int i=0; i<Nold; i++) keep[i] = 0;
+    for(int n=0; n<Nnew; n++)
+    {
+        slot[n] = NULL;
+        for(int i=0; i<Nold; i++)
+        {
+            if(!keep[i] && memcmp(cache->source[i]->params, params[n], NP*sizeof(double))==0)
+            {
+                keep[i] = 1;
+                slot[n] = cache->source[i];
+                break;
+            }
+        }
+    }
+    
+    //remove waveforms of sources that moved or are gone, and recycle their memory
+    int Nfree = 0;
+    struct Source *unused[cache->Nmax];
+    for(int i=0; i<Nold; i++)
+    {
+        if(keep[i]) continue;
+        add_neighbor_waveform(data, cache->source[i], delta, -1.0, imin, imax);
+        unused[Nfree++] = cache->source[i];
+    }
+    for(int i=Nold; i<cache->Nmax; i++) unused[Nfree++] = cache->source[i];
+    
+    //generate waveforms of new sources
+    for(int n=0; n<Nnew; n++)
+    {
+        if(slot[n]!=NULL) continue;
+        
+        struct Source *source = slot[n] = unused[--Nfree];
+        memcpy(source->params, params[n], NP*sizeof(double));
+        map_array_to_params(source, source->params, data->T);
+        
+        //Book-keeping of injection time-frequency volume
+        galactic_binary_alignment(orbit, data, source);
+        for(int i=0; i<2*source->BW && i<2*data->N; i++)
+        {
+            source->tdi->X[i]=0.0;
+            source->tdi->A[i]=0.0;
+            source->tdi->E[i]=0.0;
+        }
+        
+        //Simulate gravitational wave signal
+        galactic_binary(orbit, data->format, data->T, cache->t0[FIXME], source->params, source->NP, source->tdi->X, source->tdi->A, source->tdi->E, source->BW, source->tdi->Nchannel);
+        
+        add_neighbor_waveform(data, source, delta, 1.0, imin, imax);
+    }
+    
+    //cached sources are the received ones, followed by spare memory
+    for(int n=0; n<Nnew; n++) cache->source[n] = slot[n];
+    for(int n=Nnew; n<cache->Nmax; n++) cache->source[n] = unused[--Nfree];
+    cache->Nlive = Nnew;
+}
+
+/* keep the newest message from each neighbor, @returns 1 if anything arrived */
+static int receive_gbmcmc_exchange(struct GBMCMCData *gbmcmc_data)
+{
+    int update = 0;
+    for(int side=0; side<2; side++)
+    {
+        int neighbor = gbmcmc_neighbor(gbmcmc_data, side);
+        if(neighbor<0) continue;
+        
+        while(1)
+        {
+            int arrived;
+            MPI_Status status;
+            MPI_Test(&gbmcmc_data->recv_request[side], &arrived, &status);
+            if(!arrived) break;
+            
+            MPI_Get_count(&status, MPI_DOUBLE, &gbmcmc_data->Nneighbor_params[side]);
+            memcpy(gbmcmc_data->neighbor_params[side], gbmcmc_data->recv_params[side], gbmcmc_data->Nneighbor_params[side]*sizeof(double));
+            update = 1;
+            
+            //listen for the next one
+            MPI_Irecv(gbmcmc_data->recv_params[side], gbmcmc_data->Nshare_max, MPI_DOUBLE, neighbor, EXCHANGE_TAG, MPI_COMM_WORLD, &gbmcmc_data->recv_request[side]);
+        }
+    }
+    return update;
+}
+
 void initialize_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data)
 {
     /* Aliases to gbmcmc structures */
@@ -154,6 +634,9 @@ void initialize_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data)
     
     /* Store data segment in working directory */
     print_data(data, data->tdi[0], flags, 0);
+    
+    /* Start listening to neighbors */
+    setup_gbmcmc_exchange(gbmcmc_data);
 }
 
 static void print_sampler_state(struct GBMCMCData *gbmcmc_data)
@@ -225,14 +708,8 @@ int update_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data)
             //reverse jump birth/death move
             if(flags->rj) galactic_binary_rjmcmc(orbit, data, model_ptr, trial_ptr, chain, flags, prior, proposal, ic);
             
-            //update fisher matrix for each chain
-            if(gbmcmc_data->mcmc_step%100==0)
-            {
-                for(int n=0; n<model_ptr->Nlive; n++)
-                {
-                    galactic_binary_fisher(orbit, data, model_ptr->source[n], data->noise[FIXME]);
-                }
-            }
+            //update fisher matrices that have gone stale
+            update_fisher_matrices(orbit, data, model_ptr, chain->temperature[ic]);
             
         }// end (parallel) loop over chains
          //Next section is single threaded. Every thread must get here before continuing
@@ -242,6 +719,10 @@ int update_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data)
             ptmcmc(model,chain,flags);
             adapt_temperature_ladder(chain, gbmcmc_data->mcmc_step+flags->NBURN);
             
+            //tune proposal weights during burn in, frozen afterwards
+            if(flags->tuneProposals && flags->burnin && gbmcmc_data->mcmc_step%100==0)
+                tune_proposal_weights(proposal, chain, flags, gbmcmc_data->mcmc_step);
+            
             print_chain_files(data, model, chain, flags, gbmcmc_data->mcmc_step);
             
             //track maximum log Likelihood
@@ -291,158 +772,141 @@ int update_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data)
 void exchange_gbmcmc_source_params(struct GBMCMCData *gbmcmc_data)
 {
     /* aliases for contents of GBMCMCdata structure */
-    int procID     = gbmcmc_data->procID;
-    int procID_min = gbmcmc_data->procID_min;
-    int procID_max = gbmcmc_data->procID_max;
-    
     struct Flags *flags = gbmcmc_data->flags;
-    struct Orbit *orbit = gbmcmc_data->orbit;
     struct Chain *chain = gbmcmc_data->chain;
     struct Data  *data  = gbmcmc_data->data;
     struct Model *model = gbmcmc_data->model[chain->index[0]];
     
-    int tag = 1; /* MPI tag for parameter exchange */
-    
     //aliases for needed contents of model structure
     int Nshare = 0;
     int Nlive  = model->Nlive;
     int NP = model->NP;
-    int share_flag[Nlive];
     struct Source **source = model->source;
     
-    /* count how many sources are shareable */
-    for(int n=0; n<Nlive; n++)
+    /* collect newest sources from neighbors, previous cycle's are used otherwise */
+    int imin = data->N;
+    int imax = 0;
+    if(receive_gbmcmc_exchange(gbmcmc_data)) update_neighbor_sources(gbmcmc_data, &imin, &imax);
+    
+    /*
+     Data::tdi changes by -delta over [imin,imax). Likelihoods only change over
+     those bins, unless the noise model was updated since the last exchange.
+     */
+    struct TDI *delta = gbmcmc_data->neighbor_model->tdi[FIXME];
+    if(!flags->prior && !gbmcmc_data->logL_stale && imin<imax)
     {
-        share_flag[n]=0;
-        //find central bin of source
-        double q_sample = model->source[n]->f0*data->T;
-        
-        //only share if the source is not in the padding region
-        if(q_sample > data->qmin+data->qpad && q_sample < data->qmax-data->qpad)
+        for(int ic=0; ic<chain->NC; ic++)
         {
-            share_flag[n]=1;
-            Nshare++;
+            model = gbmcmc_data->model[chain->index[ic]];
+            model->logL = data_delta_gaussian_log_likelihood(data, model, delta, imin, imax);
         }
     }
     
-    //build array of all source parameters to ship
-    int Nparams = Nshare*NP;
-    double params[Nparams]; //TODO: Allow for different number of parameters for each source
-    Nshare = 0;
-    for(int i=0; i<Nlive; i++)
+    /* form residual */
+    struct TDI *tdi = data->tdi[FIXME];
+    if(gbmcmc_data->neighbor_model->Nlive > 0)
     {
-        if(share_flag[i])
+        for(int n=2*imin; n<2*imax; n++)
         {
-            for(int n=0; n<NP; n++)
-            {
-                params[Nshare*NP+n] = source[i]->params[n];
-            }
-            Nshare++;
-            
+            tdi->X[n] -= delta->X[n];
+            tdi->A[n] -= delta->A[n];
+            tdi->E[n] -= delta->E[n];
         }
     }
-    
-    /* send to either side */
-    int left_neighbor = procID-1;
-    int right_neighbor = procID+1;
-    if(left_neighbor>=procID_min)
-        MPI_Send(&params, Nparams, MPI_DOUBLE, left_neighbor, tag, MPI_COMM_WORLD);
-    if(right_neighbor<=procID_max)
-        MPI_Send(&params, Nparams, MPI_DOUBLE, right_neighbor, tag, MPI_COMM_WORLD);
-    
-    /* probe for messages from either side*/
-    MPI_Status status;
-    MPI_Status status_left;
-    MPI_Status status_right;
-    
-    int Nparams_left =0;
-    int Nparams_right=0;
-    
-    if(left_neighbor>=procID_min)
-    {   MPI_Probe(left_neighbor, tag, MPI_COMM_WORLD, &status_left);
-        MPI_Get_count(&status_left, MPI_DOUBLE, &Nparams_left);
-    }
-    if(right_neighbor<=procID_max)
+    else if(imin<imax)
     {
-        MPI_Probe(right_neighbor, tag, MPI_COMM_WORLD, &status_right);
-        MPI_Get_count(&status_right, MPI_DOUBLE, &Nparams_right);
+        /* neighbors have nothing in the overlap any more, reset to raw data (and any round-off) */
+        memcpy(tdi->X, data->raw[FIXME]->X, 2*data->N*sizeof(double));
+        memcpy(tdi->A, data->raw[FIXME]->A, 2*data->N*sizeof(double));
+        memcpy(tdi->E, data->raw[FIXME]->E, 2*data->N*sizeof(double));
     }
     
-    /* create arrays to receive messages */
-    double params_right[Nparams_right];
-    double params_left[Nparams_left];
-    
-    /* recieve */
-    if(left_neighbor>=procID_min)
-        MPI_Recv(&params_left, Nparams_left, MPI_DOUBLE, left_neighbor, tag, MPI_COMM_WORLD,&status);
-    if(right_neighbor<=procID_max)
-        MPI_Recv(&params_right, Nparams_right, MPI_DOUBLE, right_neighbor, tag, MPI_COMM_WORLD,&status);
-    
-    /* populate new model structure with neighboring waveforms */
-    int Nparams_new = Nparams_left + Nparams_right;
-    int Nlive_new = Nparams_new/NP;
+    //delta is only nonzero over the changed bins
+    for(int n=2*imin; n<2*imax; n++) delta->X[n] = delta->A[n] = delta->E[n] = 0.0;
     
-    if(Nlive_new > 0)
+    /* ship sources once the previous messages have been delivered */
+    int delivered;
+    MPI_Testall(2, gbmcmc_data->send_request, &delivered, MPI_STATUSES_IGNORE);
+    if(delivered)
     {
-        struct Model *new_model = malloc(sizeof(struct Model));
-        alloc_model(new_model,Nlive_new,data->N,data->Nchannel,NP,flags->NT);
-        new_model->Nlive = Nlive_new;
-        //set noise model
-        for(int j=0; j<flags->NT; j++) copy_noise(data->noise[j], new_model->noise[j]);
-        
-        /* unpack recieved parameter vectors into source structures and generate waveforms */
-        int m=0;
-        for(int n=0; n<Nparams_left/NP; n++)
-        {
-            for(int i=0; i<NP; i++)
-            {
-                new_model->source[n]->params[i] = params_left[n*NP+i];
-            }
-        }
-        for(int n=0; n<Nparams_right/NP; n++)
+        //build array of all source parameters to ship
+        double *params = gbmcmc_data->share_params; //TODO: Allow for different number of parameters for each source
+        for(int i=0; i<Nlive; i++)
         {
-            for(int i=0; i<NP; i++)
+            //find central bin of source
+            double q_sample = source[i]->f0*data->T;
+            
+            //only share if the source is not in the padding region
+            if(q_sample > data->qmin+data->qpad && q_sample < data->qmax-data->qpad)
             {
-                m = Nparams_left/NP + n;
-                new_model->source[m]->params[i] = params_right[n*NP+i];
+                for(int n=0; n<NP; n++)
+                {
+                    params[Nshare*NP+n] = source[i]->params[n];
+                }
+                Nshare++;
             }
         }
         
-        for(int n=0; n<Nlive_new; n++)
+        /* send to either side */
+        for(int side=0; side<2; side++)
         {
-            map_array_to_params(new_model->source[n], new_model->source[n]->params, data->T);
+            int neighbor = gbmcmc_neighbor(gbmcmc_data, side);
+            if(neighbor>=0)
+                MPI_Isend(params, Nshare*NP, MPI_DOUBLE, neighbor, EXCHANGE_TAG, MPI_COMM_WORLD, &gbmcmc_data->send_request[side]);
         }
-        
-        /* generate signal model for received parameters */
-        generate_signal_model(orbit, data, new_model, -1);
-        
-        /* form residual */
-        for(int i=0; i<data->NT; i++)
+    }
+    
+    /* full likelihood update after noise model changes */
+    if(gbmcmc_data->logL_stale)
+    {
+        for(int ic=0; ic<chain->NC; ic++)
         {
-            for(int n=0; n<2*data->N; n++)
+            model = gbmcmc_data->model[chain->index[ic]];
+            if(!flags->prior)
             {
-                //TODO: need support for X,Y,Z,T channels
-                data->tdi[i]->A[n] = data->raw[i]->A[n] - new_model->tdi[i]->A[n];
-                data->tdi[i]->E[n] = data->raw[i]->E[n] - new_model->tdi[i]->E[n];
+                model->logL     = gaussian_log_likelihood(data, model);
+                model->logLnorm = gaussian_log_likelihood_constant_norm(data, model);
             }
+            else model->logL = model->logLnorm = 0.0;
         }
-                
-        /* clean up */
-        free_model(new_model);
+        gbmcmc_data->logL_stale = 0;
+    }
+
+}
+
+void finish_gbmcmc_exchange(struct GBMCMCData *gbmcmc_data)
+{
+    /* keep draining neighbors until our own messages are delivered */
+    int delivered = 0;
+    while(!delivered)
+    {
+        receive_gbmcmc_exchange(gbmcmc_data);
+        MPI_Testall(2, gbmcmc_data->send_request, &delivered, MPI_STATUSES_IGNORE);
     }
     
-    /* update likelihoods */
-    for(int ic=0; ic<chain->NC; ic++)
+    /* nothing else is in flight once every segment gets here, neighbors may still need us to listen */
+    int finished = 0;
+    MPI_Request barrier;
+    MPI_Ibarrier(gbmcmc_data->comm, &barrier);
+    while(!finished)
     {
-        model = gbmcmc_data->model[chain->index[ic]];
-        if(!flags->prior)
+        receive_gbmcmc_exchange(gbmcmc_data);
+        MPI_Test(&barrier, &finished, MPI_STATUS_IGNORE);
+    }
+    
+    for(int side=0; side<2; side++)
+    {
+        if(gbmcmc_data->recv_request[side] != MPI_REQUEST_NULL)
         {
-            model->logL     = gaussian_log_likelihood(data, model);
-            model->logLnorm = gaussian_log_likelihood_constant_norm(data, model);
+            MPI_Cancel(&gbmcmc_data->recv_request[side]);
+            MPI_Wait(&gbmcmc_data->recv_request[side], MPI_STATUS_IGNORE);
         }
-        else model->logL = model->logLnorm = 0.0;
+        free(gbmcmc_data->recv_params[side]);
+        free(gbmcmc_data->neighbor_params[side]);
     }
-
+    free(gbmcmc_data->share_params);
+    free_model(gbmcmc_data->neighbor_model);
+    MPI_Comm_free(&gbmcmc_data->comm);
 }
 
 int get_gbmcmc_status(struct GBMCMCData *gbmcmc_data, int Nproc, int root, int procID)
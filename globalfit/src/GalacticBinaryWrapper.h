@@ -8,6 +8,8 @@
 #ifndef GalacticBinaryWrapper_h
 #define GalacticBinaryWrapper_h
 
+#include <mpi.h>
+
 struct GBMCMCData
 {
     int mcmc_step;
@@ -16,6 +18,18 @@ struct GBMCMCData
     int procID; //!<MPI process identifier
     int procID_min; //!<lowest rank MPI process for GBMCMC block
     int procID_max; //!<highest rank MPI process for GBMCMC block
+    MPI_Comm comm;  //!<communicator for GBMCMC block
+    
+    /* non-blocking neighbor exchange, see exchange_gbmcmc_source_params() */
+    int Nshare_max;                 //!<capacity of exchange buffers
+    double *share_params;           //!<source parameters in flight to neighbors
+    double *recv_params[2];         //!<receive buffers for left and right neighbors
+    double *neighbor_params[2];     //!<most recent source parameters from left and right neighbors
+    int Nneighbor_params[2];        //!<size of neighbor_params
+    MPI_Request send_request[2];    //!<sends to left and right neighbors
+    MPI_Request recv_request[2];    //!<receives from left and right neighbors
+    struct Model *neighbor_model;   //!<cached waveforms of the neighbors' sources subtracted from Data::tdi
+    int logL_stale;                 //!<noise model changed since chain likelihoods were computed
     
     struct Flags *flags;
     struct Orbit *orbit;
@@ -31,16 +45,50 @@ void alloc_gbmcmc_data(struct GBMCMCData *gbmcmc_data, int procID, int procID_mi
 
 void select_frequency_segment(struct Data *data, struct TDI *tdi_full, int procID);
 
+/**
+ \brief Distribute each gbmcmc process's padded frequency segment from `root`
+ 
+ Only `root` needs `tdi_full`. Workers receive 2*Data::N samples of the
+ A&E channels (all channels if Data::Nchannel!=2) directly into Data::tdi and Data::raw.
+ */
 void get_frequency_segment(struct Data *data, struct TDI *tdi_full, int Nsamples, int root, int procID);
 
+/**
+ \brief Cooperative HDF5 ingest and Fourier transform of the data segment
+ 
+ Ingest processes each read an equal time slice of the HDF5 data with
+ GalacticBinaryReadHDF5Slice() and Fourier transform it together, with a
+ transpose based distributed FFT. Each gbmcmc process ends up with only its
+ frequency segment, `root` with the band used by the noise model in `tdi_full`.
+ 
+ @returns 0 without doing anything if the segment length is not a power of two,
+ in which case use GalacticBinaryReadHDF5() and get_frequency_segment()
+ */
+int get_frequency_segment_parallel(struct Data *data, struct TDI *tdi_full, int root, int procID);
+
 void broadcast_cache(struct Data *data, int root, int procID);
 
 void initialize_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data);
 
 int update_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data);
 
+/**
+ \brief Non-blocking exchange of source parameters with neighboring segments
+ 
+ Sources outside of the padding are sent to both neighbors with `MPI_Isend`
+ once the previous messages have been delivered, so the exchange overlaps with
+ the next block of MCMC steps. The residual is rebuilt from the latest sources
+ received from each neighbor, or kept from an earlier cycle if nothing new has
+ arrived. Neighbor waveforms are cached in GBMCMCData::neighbor_model and only
+ sources whose parameters changed are regenerated, with the difference applied
+ to Data::tdi in place. Chain likelihoods are updated over the changed bins,
+ unless GBMCMCData::logL_stale forces a full calculation.
+ */
 void exchange_gbmcmc_source_params(struct GBMCMCData *gbmcmc_data);
 
+/// Deliver outstanding neighbor exchanges and free exchange buffers, collective over GBMCMCData::comm
+void finish_gbmcmc_exchange(struct GBMCMCData *gbmcmc_data);
+
 int get_gbmcmc_status(struct GBMCMCData *gbmcmc_data, int Nproc, int root, int procID);
 
 #endif /* GalacticBinaryWrapper_h */
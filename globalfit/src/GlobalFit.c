@@ -6,6 +6,7 @@
 //
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/stat.h>
@@ -31,6 +32,10 @@
 
 #define NMAX 10
 
+/* message tags for asynchronous Gibbs snapshots */
+#define RESIDUAL_SNAPSHOT 2
+#define NOISE_SNAPSHOT 3
+
 static void share_gbmcmc_residual(struct GBMCMCData *gbmcmc_data, struct NoiseData *noise_data, int GBMCMC_Flag, int Noise_Flag, int root)
 {
     if(GBMCMC_Flag)
@@ -58,6 +63,27 @@ static void share_gbmcmc_residual(struct GBMCMCData *gbmcmc_data, struct NoiseDa
     }
 }
 
+/* propagate noise model received by the cold chain to every chain */
+static void update_gbmcmc_noise(struct GBMCMCData *gbmcmc_data)
+{
+    struct Data *data = gbmcmc_data->data;
+    struct Chain *chain = gbmcmc_data->chain;
+    struct Model *model = gbmcmc_data->model[chain->index[0]];
+
+    invert_noise(model->noise[0]);
+    
+    //copy new noise parameters to each chain & update PSD
+    for(int i=1; i<chain->NC; i++)
+    {
+        memcpy(gbmcmc_data->model[chain->index[i]]->noise[0]->SnA,model->noise[0]->SnA, data->N*sizeof(double));
+        memcpy(gbmcmc_data->model[chain->index[i]]->noise[0]->SnE,model->noise[0]->SnE, data->N*sizeof(double));
+        invert_noise(gbmcmc_data->model[chain->index[i]]->noise[0]);
+    }
+    
+    //likelihoods need a full update with the new noise model
+    gbmcmc_data->logL_stale = 1;
+}
+
 static void share_noise_model(struct GBMCMCData *gbmcmc_data, struct NoiseData *noise_data, int GBMCMC_Flag, int Noise_Flag, int root)
 {
     if(Noise_Flag)
@@ -84,14 +110,265 @@ static void share_noise_model(struct GBMCMCData *gbmcmc_data, struct NoiseData *
         
         MPI_Recv(model->noise[0]->SnA, data->N, MPI_DOUBLE, root, 0, MPI_COMM_WORLD, &status);
         MPI_Recv(model->noise[0]->SnE, data->N, MPI_DOUBLE, root, 1, MPI_COMM_WORLD, &status);
+        update_gbmcmc_noise(gbmcmc_data);
+    }
+}
+
+/*
+ * Asynchronous blocked Gibbs sampler
+ *
+ * Each model component updates on its own processes without waiting for the
+ * others, publishing a snapshot of its state every Flags::asyncGibbs updates.
+ * Consumers always use the newest snapshot that has arrived, which may be
+ * a few updates old.
+ */
+
+/* newest state received from another model component */
+struct Snapshot
+{
+    int size;      //!<number of doubles in snapshot, including leading producer update count
+    int source;    //!<process publishing the snapshot
+    int tag;       //!<message tag of the snapshot
+    int age;       //!<consumer updates since Snapshot::latest arrived
+    double *recv;  //!<buffer for pending receive
+    double *latest;//!<newest complete snapshot
+    MPI_Request request;
+};
+
+static void open_snapshot(struct Snapshot *snapshot, int size, int source, int tag)
+{
+    snapshot->size   = size;
+    snapshot->source = source;
+    snapshot->tag    = tag;
+    snapshot->age    = 0;
+    snapshot->recv   = malloc(size*sizeof(double));
+    snapshot->latest = calloc(size,sizeof(double));
+    MPI_Irecv(snapshot->recv, size, MPI_DOUBLE, source, tag, MPI_COMM_WORLD, &snapshot->request);
+}
+
+/* drain pending snapshots keeping the newest, returns 1 if any arrived */
+static int receive_snapshot(struct Snapshot *snapshot)
+{
+    int arrived = 0;
+    int flag = 1;
+    while(flag)
+    {
+        MPI_Test(&snapshot->request, &flag, MPI_STATUS_IGNORE);
+        if(flag)
+        {
+            memcpy(snapshot->latest, snapshot->recv, snapshot->size*sizeof(double));
+            MPI_Irecv(snapshot->recv, snapshot->size, MPI_DOUBLE, snapshot->source, snapshot->tag, MPI_COMM_WORLD, &snapshot->request);
+            arrived = 1;
+        }
+    }
+    return arrived;
+}
+
+/* deliver outstanding snapshots, then stop listening once every process has */
+static void close_snapshots(struct Snapshot *snapshot, int Nrecv, MPI_Request *send, int Nsend)
+{
+    /* keep draining until our own snapshots are delivered */
+    int delivered = 0;
+    while(!delivered)
+    {
+        for(int n=0; n<Nrecv; n++) receive_snapshot(&snapshot[n]);
+        MPI_Testall(Nsend, send, &delivered, MPI_STATUSES_IGNORE);
+    }
+    
+    /* others may still be waiting on us to listen */
+    int finished = 0;
+    MPI_Request barrier;
+    MPI_Ibarrier(MPI_COMM_WORLD, &barrier);
+    while(!finished)
+    {
+        for(int n=0; n<Nrecv; n++) receive_snapshot(&snapshot[n]);
+        MPI_Test(&barrier, &finished, MPI_STATUS_IGNORE);
+    }
+    
+    for(int n=0; n<Nrecv; n++)
+    {
+        MPI_Cancel(&snapshot[n].request);
+        MPI_Wait(&snapshot[n].request, MPI_STATUS_IGNORE);
+        free(snapshot[n].recv);
+        free(snapshot[n].latest);
+    }
+}
+
+static void async_gbmcmc_sampler(struct GBMCMCData *gbmcmc_data, int root, double *busy, double *wall)
+{
+    struct Flags *flags = gbmcmc_data->flags;
+    struct Chain *chain = gbmcmc_data->chain;
+    struct Data *data   = gbmcmc_data->data;
+    
+    int N = data->N;
+    int cycle = 0;
+    int delivered;
+    double start = MPI_Wtime();
+    double t;
+    
+    /* noise model snapshots from root, residual snapshots to root */
+    struct Snapshot noise;
+    open_snapshot(&noise, 2*N+1, root, NOISE_SNAPSHOT);
+    
+    double *residual = malloc((4*N+1)*sizeof(double));
+    MPI_Request send = MPI_REQUEST_NULL;
+    
+    char filename[MAXSTRINGSIZE];
+    sprintf(filename,"%s/data/scheduler.dat",flags->runDir);
+    FILE *fptr = fopen(filename,"w");
+    fprintf(fptr,"#update wall busy idle noise_age noise_update\n");
+    
+    do
+    {
+        /* use newest noise model */
+        if(receive_snapshot(&noise))
+        {
+            struct Model *model = gbmcmc_data->model[chain->index[0]];
+            memcpy(model->noise[0]->SnA, noise.latest+1,   N*sizeof(double));
+            memcpy(model->noise[0]->SnE, noise.latest+1+N, N*sizeof(double));
+            update_gbmcmc_noise(gbmcmc_data);
+            noise.age = 0;
+        }
+        else noise.age++;
         
-        //copy new noise parameters to each chain & update PSD
-        for(int i=1; i<chain->NC; i++)
+        /* gbmcmc sampler gibbs update */
+        t = MPI_Wtime();
+        gbmcmc_data->status = update_gbmcmc_sampler(gbmcmc_data);
+        *busy += MPI_Wtime() - t;
+        cycle++;
+        
+        /* publish residual if root has picked up the last one */
+        if(cycle%flags->asyncGibbs==0 || gbmcmc_data->status==0)
         {
-            memcpy(gbmcmc_data->model[chain->index[i]]->noise[0]->SnA,model->noise[0]->SnA, data->N*sizeof(double));
-            memcpy(gbmcmc_data->model[chain->index[i]]->noise[0]->SnE,model->noise[0]->SnE, data->N*sizeof(double));
+            MPI_Test(&send, &delivered, MPI_STATUS_IGNORE);
+            if(delivered)
+            {
+                struct Model *model = gbmcmc_data->model[chain->index[0]];
+                residual[0] = (double)cycle;
+                memcpy(residual+1,     model->residual[0]->A, 2*N*sizeof(double));
+                memcpy(residual+1+2*N, model->residual[0]->E, 2*N*sizeof(double));
+                MPI_Isend(residual, 4*N+1, MPI_DOUBLE, root, RESIDUAL_SNAPSHOT, MPI_COMM_WORLD, &send);
+            }
         }
+        
+        t = MPI_Wtime() - start;
+        fprintf(fptr,"%i %lg %lg %lg %i %i\n",cycle, t, *busy, t-*busy, noise.age, (int)noise.latest[0]);
+        
+    }while(gbmcmc_data->status!=0);
+    
+    /* segment is finished, listen until every other segment is too */
+    int finished = 0;
+    MPI_Request done;
+    MPI_Ibarrier(MPI_COMM_WORLD, &done);
+    while(!finished)
+    {
+        receive_snapshot(&noise);
+        MPI_Test(&done, &finished, MPI_STATUS_IGNORE);
     }
+    
+    close_snapshots(&noise, 1, &send, 1);
+    
+    *wall = MPI_Wtime() - start;
+    fprintf(fptr,"#finished after %lg s, idle %lg s\n", *wall, *wall-*busy);
+    fclose(fptr);
+    free(residual);
+}
+
+static void async_noise_sampler(struct GBMCMCData *gbmcmc_data, struct NoiseData *noise_data, int root, double *busy, double *wall)
+{
+    struct Flags *flags = gbmcmc_data->flags;
+    struct Data *data   = noise_data->data;
+    
+    int procID_min = gbmcmc_data->procID_min;
+    int Nseg = gbmcmc_data->procID_max - procID_min + 1;
+    int N = gbmcmc_data->data->N;
+    int Nstride = N - 2*gbmcmc_data->data->qpad;
+    int cycle = 0;
+    int delivered;
+    double start = MPI_Wtime();
+    double t;
+    
+    /* residual snapshots from each segment, noise model snapshots to each segment */
+    struct Snapshot *residual = malloc(Nseg*sizeof(struct Snapshot));
+    double **noise = malloc(Nseg*sizeof(double *));
+    MPI_Request *send = malloc(Nseg*sizeof(MPI_Request));
+    for(int n=0; n<Nseg; n++)
+    {
+        open_snapshot(&residual[n], 4*N+1, procID_min+n, RESIDUAL_SNAPSHOT);
+        noise[n] = malloc((2*N+1)*sizeof(double));
+        send[n] = MPI_REQUEST_NULL;
+    }
+    
+    char filename[MAXSTRINGSIZE];
+    sprintf(filename,"%s/data/scheduler.dat",noise_data->flags->runDir);
+    FILE *fptr = fopen(filename,"w");
+    fprintf(fptr,"#update wall busy idle max_residual_age mean_residual_age\n");
+    
+    /* noise model runs until every segment is finished */
+    int finished = 0;
+    MPI_Request done;
+    MPI_Ibarrier(MPI_COMM_WORLD, &done);
+    
+    while(1)
+    {
+        MPI_Test(&done, &finished, MPI_STATUS_IGNORE);
+        if(finished) break;
+        
+        /* use newest residual from each segment */
+        int max_age = 0;
+        double mean_age = 0.0;
+        for(int n=0; n<Nseg; n++)
+        {
+            if(receive_snapshot(&residual[n]))
+            {
+                int index = 2*n*Nstride;
+                memcpy(data->tdi[0]->A+index, residual[n].latest+1,     2*N*sizeof(double));
+                memcpy(data->tdi[0]->E+index, residual[n].latest+1+2*N, 2*N*sizeof(double));
+                residual[n].age = 0;
+            }
+            else residual[n].age++;
+            
+            if(residual[n].age > max_age) max_age = residual[n].age;
+            mean_age += (double)residual[n].age/(double)Nseg;
+        }
+        
+        /* noise model update */
+        t = MPI_Wtime();
+        noise_data->status = update_noise_sampler(noise_data);
+        *busy += MPI_Wtime() - t;
+        cycle++;
+        
+        /* publish noise model to each segment that has picked up the last one */
+        if(cycle%flags->asyncGibbs==0)
+        {
+            struct SplineModel *model = noise_data->model[noise_data->chain->index[0]];
+            for(int n=0; n<Nseg; n++)
+            {
+                MPI_Test(&send[n], &delivered, MPI_STATUS_IGNORE);
+                if(!delivered) continue;
+                
+                int index = n*Nstride;
+                noise[n][0] = (double)cycle;
+                memcpy(noise[n]+1,   model->psd->SnA+index, N*sizeof(double));
+                memcpy(noise[n]+1+N, model->psd->SnE+index, N*sizeof(double));
+                MPI_Isend(noise[n], 2*N+1, MPI_DOUBLE, procID_min+n, NOISE_SNAPSHOT, MPI_COMM_WORLD, &send[n]);
+            }
+        }
+        
+        t = MPI_Wtime() - start;
+        fprintf(fptr,"%i %lg %lg %lg %i %lg\n",cycle, t, *busy, t-*busy, max_age, mean_age);
+    }
+    
+    close_snapshots(residual, Nseg, send, Nseg);
+    
+    *wall = MPI_Wtime() - start;
+    fprintf(fptr,"#finished after %lg s, idle %lg s\n", *wall, *wall-*busy);
+    fclose(fptr);
+    
+    for(int n=0; n<Nseg; n++) free(noise[n]);
+    free(noise);
+    free(send);
+    free(residual);
 }
 
 
@@ -145,11 +422,15 @@ int main(int argc, char *argv[])
     /* TDI structure to hold full dataset */
     struct TDI *tdi_full = malloc(sizeof(struct TDI));
 
-    /* root process reads data */
-    if(procID==root) GalacticBinaryReadHDF5(data,tdi_full);
+    /* all processes read and transform data together, each keeping its frequency segment */
+    if(!(flags->parallelIngest && get_frequency_segment_parallel(gbmcmc_data->data, tdi_full, root, procID)))
+    {
+        /* root process reads data */
+        if(procID==root) GalacticBinaryReadHDF5(data,tdi_full);
 
-    /* broadcast data to all gbmcmc processes and select frequency segment */
-    get_frequency_segment(gbmcmc_data->data, tdi_full, tdi_full->N, root, procID);
+        /* send each gbmcmc process its frequency segment */
+        get_frequency_segment(gbmcmc_data->data, tdi_full, tdi_full->N, root, procID);
+    }
 
     /* set up data for noise model processes */
     if(procID==root) setup_noise_data(noise_data, gbmcmc_data, tdi_full);
@@ -194,11 +475,30 @@ int main(int argc, char *argv[])
     }
     
     
+    /*
+     * Asynchronous Blocked Gibbs sampler
+     *
+     */
+    if(flags->asyncGibbs)
+    {
+        double busy = 0.0;
+        double wall = 0.0;
+        
+        if(GBMCMC_Flag) async_gbmcmc_sampler(gbmcmc_data, root, &busy, &wall);
+        if(Noise_Flag)  async_noise_sampler(gbmcmc_data, noise_data, root, &busy, &wall);
+        
+        /* report how much time the samplers spent waiting */
+        double time[2] = {busy, wall};
+        double total[2];
+        MPI_Reduce(time, total, 2, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+        if(procID==root) printf(" SAMPLER UTILIZATION = %g%% (idle %g of %g process-seconds)\n",100.*total[0]/total[1],total[1]-total[0],total[1]);
+    }
+    
     /*
      * Master Blocked Gibbs sampler
      *
      */
-    do
+    else do
     {
         /* ============================= */
         /*     ULTRACOMPACT BINARIES     */
@@ -234,6 +534,9 @@ int main(int argc, char *argv[])
 
     }while(gbmcmc_data->status!=0);
     
+    /* deliver outstanding source parameter exchanges */
+    if(GBMCMC_Flag) finish_gbmcmc_exchange(gbmcmc_data);
+    
     /*
      * Post processing model components
      *
@@ -44,15 +44,21 @@ void print_LISA_ASCII_art(FILE *fptr)
     fprintf(fptr,"                   OOOOOO                 \n");
 }
 
+/* spline lookups are not thread safe through a shared accelerator */
+static gsl_interp_accel *orbit_acc = NULL;
+#pragma omp threadprivate(orbit_acc)
+
 void interpolate_orbits(struct Orbit *orbit, double t, double *x, double *y, double *z)
 {
     int i;
     
+    if(orbit_acc == NULL) orbit_acc = gsl_interp_accel_alloc();
+    
     for(i=0; i<3; i++)
     {
-        x[i+1] = gsl_spline_eval(orbit->dx[i], t, orbit->acc);
-        y[i+1] = gsl_spline_eval(orbit->dy[i], t, orbit->acc);
-        z[i+1] = gsl_spline_eval(orbit->dz[i], t, orbit->acc);
+        x[i+1] = gsl_spline_eval(orbit->dx[i], t, orbit_acc);
+        y[i+1] = gsl_spline_eval(orbit->dy[i], t, orbit_acc);
+        z[i+1] = gsl_spline_eval(orbit->dz[i], t, orbit_acc);
     }
 }
 
@@ -297,6 +303,133 @@ void free_orbit(struct Orbit *orbit)
     free(orbit);
 }
 
+#define ORBIT_CACHE_SIZE 8
+
+static double **alloc_orbit_table(int N, int M)
+{
+    double **table = malloc(N*sizeof(double *));
+    for(int n=0; n<N; n++) table[n] = calloc(M,sizeof(double));
+    return table;
+}
+
+static void free_orbit_table(double **table, int N)
+{
+    for(int n=0; n<N; n++) free(table[n]);
+    free(table);
+}
+
+static void alloc_orbit_cache(struct OrbitCache *cache, int BWmax)
+{
+    cache->orbit = NULL;
+    cache->BW    = 0;
+    cache->BWmax = BWmax;
+    cache->x   = alloc_orbit_table(BWmax,4);
+    cache->y   = alloc_orbit_table(BWmax,4);
+    cache->z   = alloc_orbit_table(BWmax,4);
+    cache->r12 = alloc_orbit_table(BWmax,4);
+    cache->r13 = alloc_orbit_table(BWmax,4);
+    cache->r23 = alloc_orbit_table(BWmax,4);
+    cache->rr12 = alloc_orbit_table(BWmax,6);
+    cache->rr13 = alloc_orbit_table(BWmax,6);
+    cache->rr23 = alloc_orbit_table(BWmax,6);
+    cache->L12 = calloc(BWmax,sizeof(double));
+    cache->L13 = calloc(BWmax,sizeof(double));
+    cache->L23 = calloc(BWmax,sizeof(double));
+}
+
+static void free_orbit_cache(struct OrbitCache *cache)
+{
+    free_orbit_table(cache->x,cache->BWmax);
+    free_orbit_table(cache->y,cache->BWmax);
+    free_orbit_table(cache->z,cache->BWmax);
+    free_orbit_table(cache->r12,cache->BWmax);
+    free_orbit_table(cache->r13,cache->BWmax);
+    free_orbit_table(cache->r23,cache->BWmax);
+    free_orbit_table(cache->rr12,cache->BWmax);
+    free_orbit_table(cache->rr13,cache->BWmax);
+    free_orbit_table(cache->rr23,cache->BWmax);
+    free(cache->L12);
+    free(cache->L13);
+    free(cache->L23);
+}
+
+static void arm_projection_tensor(double *r, double *rr)
+{
+    rr[0] = r[1]*r[1];
+    rr[1] = r[2]*r[2];
+    rr[2] = r[3]*r[3];
+    rr[3] = r[1]*r[2];
+    rr[4] = r[1]*r[3];
+    rr[5] = r[2]*r[3];
+}
+
+static void fill_orbit_cache(struct OrbitCache *cache, struct Orbit *orbit, double t0, double T, int BW)
+{
+    double *x,*y,*z;
+    
+    cache->orbit = orbit;
+    cache->t0    = t0;
+    cache->T     = T;
+    cache->BW    = BW;
+    
+    for(int n=0; n<BW; n++)
+    {
+        //First time sample must be at t=0 for phasing
+        double t = t0 + T*(double)n/(double)BW;
+        
+        x = cache->x[n];
+        y = cache->y[n];
+        z = cache->z[n];
+        (*orbit->orbit_function)(orbit, t, x, y, z);
+        
+        cache->r12[n][1] = (x[2] - x[1])/orbit->L;   cache->r13[n][1] = (x[3] - x[1])/orbit->L;   cache->r23[n][1] = (x[3] - x[2])/orbit->L;
+        cache->r12[n][2] = (y[2] - y[1])/orbit->L;   cache->r13[n][2] = (y[3] - y[1])/orbit->L;   cache->r23[n][2] = (y[3] - y[2])/orbit->L;
+        cache->r12[n][3] = (z[2] - z[1])/orbit->L;   cache->r13[n][3] = (z[3] - z[1])/orbit->L;   cache->r23[n][3] = (z[3] - z[2])/orbit->L;
+        
+        arm_projection_tensor(cache->r12[n], cache->rr12[n]);
+        arm_projection_tensor(cache->r13[n], cache->rr13[n]);
+        arm_projection_tensor(cache->r23[n], cache->rr23[n]);
+        
+        cache->L12[n] = orbit->L*sqrt(cache->r12[n][1]*cache->r12[n][1] + cache->r12[n][2]*cache->r12[n][2] + cache->r12[n][3]*cache->r12[n][3]);
+        cache->L13[n] = orbit->L*sqrt(cache->r13[n][1]*cache->r13[n][1] + cache->r13[n][2]*cache->r13[n][2] + cache->r13[n][3]*cache->r13[n][3]);
+        cache->L23[n] = orbit->L*sqrt(cache->r23[n][1]*cache->r23[n][1] + cache->r23[n][2]*cache->r23[n][2] + cache->r23[n][3]*cache->r23[n][3]);
+    }
+}
+
+/* small per-thread table of recently used ephemerides */
+static struct OrbitCache *orbit_cache = NULL;
+static int orbit_cache_next = 0;
+#pragma omp threadprivate(orbit_cache, orbit_cache_next)
+
+struct OrbitCache *get_orbit_cache(struct Orbit *orbit, double t0, double T, int BW)
+{
+    int i;
+    
+    if(orbit_cache == NULL)
+    {
+        orbit_cache = malloc(ORBIT_CACHE_SIZE*sizeof(struct OrbitCache));
+        for(i=0; i<ORBIT_CACHE_SIZE; i++) alloc_orbit_cache(&orbit_cache[i], BW);
+    }
+    
+    for(i=0; i<ORBIT_CACHE_SIZE; i++)
+    {
+        struct OrbitCache *cache = &orbit_cache[i];
+        if(cache->orbit==orbit && cache->BW==BW && cache->t0==t0 && cache->T==T) return cache;
+    }
+    
+    struct OrbitCache *cache = &orbit_cache[orbit_cache_next];
+    orbit_cache_next = (orbit_cache_next+1)%ORBIT_CACHE_SIZE;
+    
+    if(cache->BWmax < BW)
+    {
+        free_orbit_cache(cache);
+        alloc_orbit_cache(cache, BW);
+    }
+    fill_orbit_cache(cache, orbit, t0, T, BW);
+    
+    return cache;
+}
+
 static void recursive_phase_evolution(double dre, double dim, double *cosPhase, double *sinPhase)
 {
    /* Update re and im for the next iteration. */
@@ -326,12 +459,11 @@ static void triple_angle(double cosA, double sinA, double cos2A, double *cos3A,
 void LISA_tdi(double L, double fstar, double T, double ***d, double f0, long q, double *M, double *A, double *E, int BW, int NI)
 {
     int i,j,k;
-    int BW2   = BW*2;
     int BWon2 = BW/2;
     double fonfs;
     double c3, s3, c2, s2, c1, s1;
     double f;
-    double X[BW2+1],Y[BW2+1],Z[BW2+1];
+    double Xj,Xk,Yj,Yk,Zj,Zk;
     double phiLS, cLS, sLS;
     double sqT=sqrt(T);
     double invfstar = 1./fstar;
@@ -376,56 +508,56 @@ void LISA_tdi(double L, double fstar, double T, double ***d, double f0, long q,
         double_angle(c1,s1,&c2,&s2);
         triple_angle(c1,s1,c2,&c3,&s3);
 
-        X[j] =	(d[1][2][j]-d[1][3][j])*c3 + (d[1][2][k]-d[1][3][k])*s3 +
+        Xj =	(d[1][2][j]-d[1][3][j])*c3 + (d[1][2][k]-d[1][3][k])*s3 +
         (d[2][1][j]-d[3][1][j])*c2 + (d[2][1][k]-d[3][1][k])*s2 +
         (d[1][3][j]-d[1][2][j])*c1 + (d[1][3][k]-d[1][2][k])*s1 +
         (d[3][1][j]-d[2][1][j]);
         
-        X[k] =	(d[1][2][k]-d[1][3][k])*c3 - (d[1][2][j]-d[1][3][j])*s3 +
+        Xk =	(d[1][2][k]-d[1][3][k])*c3 - (d[1][2][j]-d[1][3][j])*s3 +
         (d[2][1][k]-d[3][1][k])*c2 - (d[2][1][j]-d[3][1][j])*s2 +
         (d[1][3][k]-d[1][2][k])*c1 - (d[1][3][j]-d[1][2][j])*s1 +
         (d[3][1][k]-d[2][1][k]);
         
-        M[j] = sqT*(X[j]*cLS - X[k]*sLS);
-        M[k] =-sqT*(X[j]*sLS + X[k]*cLS);
+        M[j] = sqT*(Xj*cLS - Xk*sLS);
+        M[k] =-sqT*(Xj*sLS + Xk*cLS);
         
         //save some CPU time when only X-channel is needed
         if(NI>1)
         {
-            Y[j] =	(d[2][3][j]-d[2][1][j])*c3 + (d[2][3][k]-d[2][1][k])*s3 +
+            Yj =	(d[2][3][j]-d[2][1][j])*c3 + (d[2][3][k]-d[2][1][k])*s3 +
             (d[3][2][j]-d[1][2][j])*c2 + (d[3][2][k]-d[1][2][k])*s2+
             (d[2][1][j]-d[2][3][j])*c1 + (d[2][1][k]-d[2][3][k])*s1+
             (d[1][2][j]-d[3][2][j]);
             
-            Y[k] =	(d[2][3][k]-d[2][1][k])*c3 - (d[2][3][j]-d[2][1][j])*s3+
+            Yk =	(d[2][3][k]-d[2][1][k])*c3 - (d[2][3][j]-d[2][1][j])*s3+
             (d[3][2][k]-d[1][2][k])*c2 - (d[3][2][j]-d[1][2][j])*s2+
             (d[2][1][k]-d[2][3][k])*c1 - (d[2][1][j]-d[2][3][j])*s1+
             (d[1][2][k]-d[3][2][k]);
             
-            Z[j] =	(d[3][1][j]-d[3][2][j])*c3 + (d[3][1][k]-d[3][2][k])*s3+
+            Zj =	(d[3][1][j]-d[3][2][j])*c3 + (d[3][1][k]-d[3][2][k])*s3+
             (d[1][3][j]-d[2][3][j])*c2 + (d[1][3][k]-d[2][3][k])*s2+
             (d[3][2][j]-d[3][1][j])*c1 + (d[3][2][k]-d[3][1][k])*s1+
             (d[2][3][j]-d[1][3][j]);
             
-            Z[k] =	(d[3][1][k]-d[3][2][k])*c3 - (d[3][1][j]-d[3][2][j])*s3+
+            Zk =	(d[3][1][k]-d[3][2][k])*c3 - (d[3][1][j]-d[3][2][j])*s3+
             (d[1][3][k]-d[2][3][k])*c2 - (d[1][3][j]-d[2][3][j])*s2+
             (d[3][2][k]-d[3][1][k])*c1 - (d[3][2][j]-d[3][1][j])*s1+
             (d[2][3][k]-d[1][3][k]);
             
             /*
-             XLS[j] =  (X[j]*cLS-X[k]*sLS);
-             XLS[k] = -(X[j]*sLS+X[k]*cLS);
-             YLS[j] =  (Y[j]*cLS-Y[k]*sLS);
-             YLS[k] = -(Y[j]*sLS+Y[k]*cLS);
-             ZLS[j] =  (Z[j]*cLS-Z[k]*sLS);
-             ZLS[k] = -(Z[j]*sLS+Z[k]*cLS);
+             XLS[j] =  (Xj*cLS-Xk*sLS);
+             XLS[k] = -(Xj*sLS+Xk*cLS);
+             YLS[j] =  (Yj*cLS-Yk*sLS);
+             YLS[k] = -(Yj*sLS+Yk*cLS);
+             ZLS[j] =  (Zj*cLS-Zk*sLS);
+             ZLS[k] = -(Zj*sLS+Zk*cLS);
              */
             
-            A[j] =  sqT*((2.0*X[j]-Y[j]-Z[j])*cLS-(2.0*X[k]-Y[k]-Z[k])*sLS)*0.33333333;
-            A[k] = -sqT*((2.0*X[j]-Y[j]-Z[j])*sLS+(2.0*X[k]-Y[k]-Z[k])*cLS)*0.33333333;
+            A[j] =  sqT*((2.0*Xj-Yj-Zj)*cLS-(2.0*Xk-Yk-Zk)*sLS)*0.33333333;
+            A[k] = -sqT*((2.0*Xj-Yj-Zj)*sLS+(2.0*Xk-Yk-Zk)*cLS)*0.33333333;
             
-            E[j] =  sqT*((Z[j]-Y[j])*cLS-(Z[k]-Y[k])*sLS)*invSQ3;
-            E[k] = -sqT*((Z[j]-Y[j])*sLS+(Z[k]-Y[k])*cLS)*invSQ3;
+            E[j] =  sqT*((Zj-Yj)*cLS-(Zk-Yk)*sLS)*invSQ3;
+            E[k] = -sqT*((Zj-Yj)*sLS+(Zk-Yk)*cLS)*invSQ3;
         }
     }
 }
@@ -433,12 +565,11 @@ void LISA_tdi(double L, double fstar, double T, double ***d, double f0, long q,
 void LISA_tdi_FF(double L, double fstar, double T, double ***d, double f0, long q, double *M, double *A, double *E, int BW, int NI)
 {
     int i,j,k;
-    int BW2   = BW*2;
     int BWon2 = BW/2;
     double fonfs,fonfs2;
     double c3, s3, c2, s2, c1, s1;
     double f;
-    double X[BW2+1],Y[BW2+1],Z[BW2+1];
+    double Xj,Xk,Yj,Yk,Zj,Zk;
     double phiSL, cSL, sSL;
     double sqT=sqrt(T);
     double invfstar = 1./fstar;
@@ -481,52 +612,52 @@ void LISA_tdi_FF(double L, double fstar, double T, double ***d, double f0, long
         triple_angle(c1,s1,c2,&c3,&s3);
         
         
-        X[j] =	(d[1][2][j]-d[1][3][j])*c3 + (d[1][2][k]-d[1][3][k])*s3 +
+        Xj =	(d[1][2][j]-d[1][3][j])*c3 + (d[1][2][k]-d[1][3][k])*s3 +
         (d[2][1][j]-d[3][1][j])*c2 + (d[2][1][k]-d[3][1][k])*s2 +
         (d[1][3][j]-d[1][2][j])*c1 + (d[1][3][k]-d[1][2][k])*s1 +
         (d[3][1][j]-d[2][1][j]);
         
-        X[k] =	(d[1][2][k]-d[1][3][k])*c3 - (d[1][2][j]-d[1][3][j])*s3 +
+        Xk =	(d[1][2][k]-d[1][3][k])*c3 - (d[1][2][j]-d[1][3][j])*s3 +
         (d[2][1][k]-d[3][1][k])*c2 - (d[2][1][j]-d[3][1][j])*s2 +
         (d[1][3][k]-d[1][2][k])*c1 - (d[1][3][j]-d[1][2][j])*s1 +
         (d[3][1][k]-d[2][1][k]);
         
-        M[j] = sqT*fonfs2*(X[j]*cSL - X[k]*sSL);
-        M[k] = sqT*fonfs2*(X[j]*sSL + X[k]*cSL);
+        M[j] = sqT*fonfs2*(Xj*cSL - Xk*sSL);
+        M[k] = sqT*fonfs2*(Xj*sSL + Xk*cSL);
         
         //save some CPU time when only X-channel is needed
         if(NI>1)
         {
-            Y[j] =	(d[2][3][j]-d[2][1][j])*c3 + (d[2][3][k]-d[2][1][k])*s3 +
+            Yj =	(d[2][3][j]-d[2][1][j])*c3 + (d[2][3][k]-d[2][1][k])*s3 +
             (d[3][2][j]-d[1][2][j])*c2 + (d[3][2][k]-d[1][2][k])*s2+
             (d[2][1][j]-d[2][3][j])*c1 + (d[2][1][k]-d[2][3][k])*s1+
             (d[1][2][j]-d[3][2][j]);
             
-            Y[k] =	(d[2][3][k]-d[2][1][k])*c3 - (d[2][3][j]-d[2][1][j])*s3+
+            Yk =	(d[2][3][k]-d[2][1][k])*c3 - (d[2][3][j]-d[2][1][j])*s3+
             (d[3][2][k]-d[1][2][k])*c2 - (d[3][2][j]-d[1][2][j])*s2+
             (d[2][1][k]-d[2][3][k])*c1 - (d[2][1][j]-d[2][3][j])*s1+
             (d[1][2][k]-d[3][2][k]);
             
-            Z[j] =	(d[3][1][j]-d[3][2][j])*c3 + (d[3][1][k]-d[3][2][k])*s3+
+            Zj =	(d[3][1][j]-d[3][2][j])*c3 + (d[3][1][k]-d[3][2][k])*s3+
             (d[1][3][j]-d[2][3][j])*c2 + (d[1][3][k]-d[2][3][k])*s2+
             (d[3][2][j]-d[3][1][j])*c1 + (d[3][2][k]-d[3][1][k])*s1+
             (d[2][3][j]-d[1][3][j]);
             
-            Z[k] =	(d[3][1][k]-d[3][2][k])*c3 - (d[3][1][j]-d[3][2][j])*s3+
+            Zk =	(d[3][1][k]-d[3][2][k])*c3 - (d[3][1][j]-d[3][2][j])*s3+
             (d[1][3][k]-d[2][3][k])*c2 - (d[1][3][j]-d[2][3][j])*s2+
             (d[3][2][k]-d[3][1][k])*c1 - (d[3][2][j]-d[3][1][j])*s1+
             (d[2][3][k]-d[1][3][k]);
             
              
-            A[j] =  sqT*fonfs2*((2.0*X[j]-Y[j]-Z[j])*cSL-(2.0*X[k]-Y[k]-Z[k])*sSL)*0.33333333;
-            A[k] =  sqT*fonfs2*((2.0*X[j]-Y[j]-Z[j])*sSL+(2.0*X[k]-Y[k]-Z[k])*cSL)*0.33333333;
+            A[j] =  sqT*fonfs2*((2.0*Xj-Yj-Zj)*cSL-(2.0*Xk-Yk-Zk)*sSL)*0.33333333;
+            A[k] =  sqT*fonfs2*((2.0*Xj-Yj-Zj)*sSL+(2.0*Xk-Yk-Zk)*cSL)*0.33333333;
             
-            E[j] =  sqT*fonfs2*((Z[j]-Y[j])*cSL-(Z[k]-Y[k])*sSL)*invSQ3;
-            E[k] =  sqT*fonfs2*((Z[j]-Y[j])*sSL+(Z[k]-Y[k])*cSL)*invSQ3;
+            E[j] =  sqT*fonfs2*((Zj-Yj)*cSL-(Zk-Yk)*sSL)*invSQ3;
+            E[k] =  sqT*fonfs2*((Zj-Yj)*sSL+(Zk-Yk)*cSL)*invSQ3;
             
 
-            //T[j] =  sqT*fonfs2*(((1./3.)*(X[j]+Y[j]+Z[j]))*cSL-((1./3.)*(X[k]+Y[k]+Z[k]))*sSL)*0.33333333;
-            //T[k] =  sqT*fonfs2*(((1./3.)*(X[j]+Y[j]+Z[j]))*sSL+((1./3.)*(X[k]+Y[k]+Z[k]))*cSL)*0.33333333;
+            //T[j] =  sqT*fonfs2*(((1./3.)*(Xj+Yj+Zj))*cSL-((1./3.)*(Xk+Yk+Zk))*sSL)*0.33333333;
+            //T[k] =  sqT*fonfs2*(((1./3.)*(Xj+Yj+Zj))*sSL+((1./3.)*(Xk+Yk+Zk))*cSL)*0.33333333;
             
         }
     }
@@ -802,15 +933,50 @@ void free_tdi(struct TDI *tdi)
 
 #define DATASET "/obs/tdi"
 
+/* LDC-formatted structure for compound HDF5 dataset */
+typedef struct tdi_dataset {
+    double time;
+    double    X;
+    double    Y;
+    double    Z;
+} tdi_dataset;
+
+static hid_t LDC_TDI_datatype(void)
+{
+    hid_t s1_tid; /* Memory datatype handle */
+    
+    s1_tid = H5Tcreate(H5T_COMPOUND, sizeof(struct tdi_dataset));
+    H5Tinsert(s1_tid, "time", HOFFSET(struct tdi_dataset, time), H5T_IEEE_F64LE);
+    H5Tinsert(s1_tid, "X", HOFFSET(struct tdi_dataset, X), H5T_IEEE_F64LE);
+    H5Tinsert(s1_tid, "Y", HOFFSET(struct tdi_dataset, Y), H5T_IEEE_F64LE);
+    H5Tinsert(s1_tid, "Z", HOFFSET(struct tdi_dataset, Z), H5T_IEEE_F64LE);
+    
+    return s1_tid;
+}
+
+/* Copy LDC-formatted structure into ldasoft format */
+static void LDC_TDI_copy(struct TDI *tdi, tdi_dataset *s1, int Nsamples)
+{
+    for(int i=0; i<Nsamples; i++)
+    {
+        double X = s1[i].X;
+        double Y = s1[i].Y;
+        double Z = s1[i].Z;
+        
+        tdi->X[i] = X;
+        tdi->Y[i] = Y;
+        tdi->Z[i] = Z;
+        
+        tdi->A[i] = (2.0*X-Y-Z)/3.0;
+        tdi->E[i] = (Z-Y)/sqrt(3.0);
+        tdi->T[i] = (X+Y+Z)/3.0;
+        
+    }
+    tdi->delta = s1[1].time - s1[0].time;
+}
+
 void LISA_Read_HDF5_LDC_TDI(struct TDI *tdi, char *fileName)
 {    
-    /* LDC-formatted structure for compound HDF5 dataset */
-    typedef struct tdi_dataset {
-        double time;
-        double    X;
-        double    Y;
-        double    Z;
-    } tdi_dataset;
     static tdi_dataset *s1;
     
     hid_t  file, dataset, dspace; /* identifiers */
@@ -833,43 +999,78 @@ void LISA_Read_HDF5_LDC_TDI(struct TDI *tdi, char *fileName)
     s1 = malloc(Nsamples*sizeof(struct tdi_dataset));
     alloc_tdi(tdi, Nsamples/2, 3);
     
-    hid_t s1_tid; /* Memory datatype handle */
-    
-    s1_tid = H5Tcreate(H5T_COMPOUND, sizeof(struct tdi_dataset));
-    H5Tinsert(s1_tid, "time", HOFFSET(struct tdi_dataset, time), H5T_IEEE_F64LE);
-    H5Tinsert(s1_tid, "X", HOFFSET(struct tdi_dataset, X), H5T_IEEE_F64LE);
-    H5Tinsert(s1_tid, "Y", HOFFSET(struct tdi_dataset, Y), H5T_IEEE_F64LE);
-    H5Tinsert(s1_tid, "Z", HOFFSET(struct tdi_dataset, Z), H5T_IEEE_F64LE);
+    hid_t s1_tid = LDC_TDI_datatype();
     
     status = H5Dread(dataset, s1_tid, H5S_ALL, H5S_ALL, H5P_DEFAULT, s1);
         
+    LDC_TDI_copy(tdi, s1, Nsamples);
     
-    /* Copy LDC-formatted structure into ldasoft format */
-    for(int i=0; i<Nsamples; i++)
+    /* Close the dataset. */
+    status = H5Tclose(s1_tid);
+    status = H5Sclose(dspace);
+    status = H5Dclose(dataset);
+    
+    /* Close the file. */
+    status = H5Fclose(file);
+    
+    /* Free up memory */
+    free(s1);
+
+}
+
+void LISA_Read_HDF5_LDC_TDI_Hyperslab(struct TDI *tdi, char *fileName, int start, int count)
+{
+    hid_t  file, dataset, dspace, mspace; /* identifiers */
+    herr_t status; /* error handling */
+    
+    if(count < 2)
     {
-        double X = s1[i].X;
-        double Y = s1[i].Y;
-        double Z = s1[i].Z;
-        
-        tdi->X[i] = X;
-        tdi->Y[i] = Y;
-        tdi->Z[i] = Z;
-        
-        tdi->A[i] = (2.0*X-Y-Z)/3.0;
-        tdi->E[i] = (Z-Y)/sqrt(3.0);
-        tdi->T[i] = (X+Y+Z)/3.0;
-        
+        fprintf(stderr,"Error reading %s: need at least 2 samples, requested %i\n",fileName,count);
+        exit(1);
     }
-    tdi->delta = s1[1].time - s1[0].time;
+    
+    /* Open an existing file. */
+    file = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT);
+    
+    /* Open an existing dataset. */
+    dataset = H5Dopen(file, DATASET, H5P_DEFAULT);
+    
+    /* Select [start,start+count) rows of the dataset */
+    dspace = H5Dget_space(dataset);
+    int ndims = H5Sget_simple_extent_ndims(dspace);
+    hsize_t dims[ndims];
+    H5Sget_simple_extent_dims(dspace, dims, NULL);
+    if(start < 0 || (hsize_t)(start + count) > dims[0])
+    {
+        fprintf(stderr,"Error reading %s: samples [%i,%i) outside of dataset [0,%i)\n",fileName,start,start+count,(int)dims[0]);
+        exit(1);
+    }
+    
+    hsize_t offset[1] = {(hsize_t)start};
+    hsize_t block[1]  = {(hsize_t)count};
+    H5Sselect_hyperslab(dspace, H5S_SELECT_SET, offset, NULL, block, NULL);
+    mspace = H5Screate_simple(1, block, NULL);
+    
+    tdi_dataset *s1 = malloc(count*sizeof(struct tdi_dataset));
+    alloc_tdi(tdi, (count+1)/2, 3);
+    
+    hid_t s1_tid = LDC_TDI_datatype();
+    
+    status = H5Dread(dataset, s1_tid, mspace, dspace, H5P_DEFAULT, s1);
+    
+    LDC_TDI_copy(tdi, s1, count);
     
     /* Close the dataset. */
+    status = H5Tclose(s1_tid);
+    status = H5Sclose(mspace);
+    status = H5Sclose(dspace);
     status = H5Dclose(dataset);
     
     /* Close the file. */
     status = H5Fclose(file);
+    (void)status;
     
     /* Free up memory */
     free(s1);
-
 }
 
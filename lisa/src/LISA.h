@@ -94,7 +94,7 @@ struct Orbit
     gsl_spline **dx; //!<spline derivatives in x-coordinate
     gsl_spline **dy; //!<spline derivatives in y-coordinate
     gsl_spline **dz; //!<spline derivatives in z-coordinate
-    gsl_interp_accel *acc; //!<gsl interpolation work space
+    gsl_interp_accel *acc; //!<gsl interpolation work space (unused by interpolate_orbits(), which keeps one accelerator per thread)
     ///@}
     
     
@@ -111,6 +111,52 @@ struct Orbit
     void (*orbit_function)(struct Orbit*,double,double*,double*,double*);
 };
 
+/**
+ \brief Spacecraft ephemerides tabulated at the time samples used by the waveform generator
+ 
+ Templates with the same start time, observation time, and bandwidth are evaluated
+ at the same times \f$ t_n = t_0 + T(n-1)/B\f$, so positions and arm vectors are computed
+ once per thread and reused.  Spacecraft indices run over 1..3, matching Orbit::orbit_function.
+ Everything stored here is independent of the source sky location, leaving only
+ the contractions with the polarization tensors to the waveform loop.
+ */
+struct OrbitCache
+{
+    /** @name Cache key */
+    ///@{
+    struct Orbit *orbit; //!<orbit model used to fill the table
+    double t0; //!<start time of first sample \f$[{\rm s}]\f$
+    double T;  //!<observation time \f$[{\rm s}]\f$
+    int BW;    //!<number of time samples
+    ///@}
+    
+    int BWmax; //!<size of allocated tables
+    
+    /** @name Tabulated ephemerides, indexed `[n][i]` for sample `n` and spacecraft `i` */
+    ///@{
+    double **x;   //!<x-coordinate
+    double **y;   //!<y-coordinate
+    double **z;   //!<z-coordinate
+    double **r12; //!<separation vector from spacecraft 1 to 2 in units of Orbit::L
+    double **r13; //!<separation vector from spacecraft 1 to 3 in units of Orbit::L
+    double **r23; //!<separation vector from spacecraft 2 to 3 in units of Orbit::L
+    ///@}
+    
+    /** @name Arm projection tensors \f$ \hat r_i \hat r_j \f$, indexed `[n][0..5]` as \f$ (11,22,33,12,13,23) \f$ */
+    ///@{
+    double **rr12;
+    double **rr13;
+    double **rr23;
+    ///@}
+    
+    /** @name Arm lengths at each sample \f$[{\rm m}]\f$ */
+    ///@{
+    double *L12;
+    double *L13;
+    double *L23;
+    ///@}
+};
+
 /**
  \brief Structure for Time Delay Interferometry data and metadata
  
@@ -202,6 +248,14 @@ void initialize_numeric_orbit(struct Orbit *orbit);
  */
 void free_orbit(struct Orbit *orbit);
 
+/**
+ \brief Returns the calling thread's OrbitCache for samples \f$ t_0 + T(n-1)/B\f$, \f$ n=1..B \f$
+ 
+ Each thread keeps a small table of recently used (orbit, t0, T, BW) keys.
+ On a miss the least recently filled entry is recomputed with Orbit::orbit_function.
+ */
+struct OrbitCache *get_orbit_cache(struct Orbit *orbit, double t0, double T, int BW);
+
 
 /**
  @name  LISA Time Delay Interferometer functions
@@ -274,4 +328,13 @@ void free_tdi(struct TDI *tdi);
  */
 void LISA_Read_HDF5_LDC_TDI(struct TDI *tdi, char *fileName);
 
+/**
+ \brief HDF5 parser for a time slice of LISA Data
+ 
+ Same as LISA_Read_HDF5_LDC_TDI() but only reads samples [`start`,`start`+`count`)
+ of the dataset with an HDF5 hyperslab selection, so processes can ingest
+ disjoint slices of the data concurrently.
+ */
+void LISA_Read_HDF5_LDC_TDI_Hyperslab(struct TDI *tdi, char *fileName, int start, int count);
+
 #endif /* LISA_h */